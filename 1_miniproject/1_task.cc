@@ -16,48 +16,52 @@ class ListError : public exception {
 // Defining class template
 template <typename T> class OrderedList1 {
 	private:
-		T* items[20]; // array of pointers
+		T* items; // contiguous buffer of values
 		int size;
+		int capacity;
 
-	public:
-		OrderedList1() : size(0) {
-			for (int i = 0; i < 20; i++) {
-				items[i] = nullptr;
+		// Double the buffer, copying the values across
+		void Grow() {
+			T* grown = new T[capacity * 2];
+			for (int i = 0; i < size; i++) {
+				grown[i] = items[i];
 			}
+			delete[] items;
+			items = grown;
+			capacity *= 2;
+		}
+
+	public:
+		OrderedList1(int initialCapacity = 20) : size(0), capacity(initialCapacity > 0 ? initialCapacity : 1) {
+			items = new T[capacity];
 		}
 	
 		// Destructor
 		~OrderedList1() {
-			MakeEmpty();
+			delete[] items;
 		}
 
+		OrderedList1(const OrderedList1&) = delete;
+		OrderedList1& operator=(const OrderedList1&) = delete;
+
 		// Check if list is empty
 		bool IsEmpty() const {
 			return size == 0;
 		}
 
-		// Check if list is full
-		bool IsFull() const {
-			return size == 20;
-		}
-
 		// Remove all items
 		void MakeEmpty() {
-			for (int i=0; i < size; i++) {
-				delete items[i];
-				items[i] = nullptr;
-			}
 			size = 0;
 		}
 
 		// Add item in order
 		void AddItem(const T& item) {
-			if (IsFull()) {
-				throw ListError("Cannot add item: list is full.");
+			if (size == capacity) {
+				Grow();
 			}
 
 			int i = 0;
-			while (i < size && *items[i] < item) {
+			while (i < size && items[i] < item) {
 				i++;
 			}
 
@@ -66,14 +70,14 @@ template <typename T> class OrderedList1 {
 				items[j] = items[j - 1];
 			}
 
-			items[i] = new T(item);
+			items[i] = item;
 			size++;
 		}
 
 		// Remove item
 		void RemoveItem(const T& item) {
 			int i=0;
-			while (i < size && !(*items[i] == item)) {
+			while (i < size && !(items[i] == item)) {
 				i++;
 			}
 
@@ -81,20 +85,17 @@ template <typename T> class OrderedList1 {
 				throw ListError("Item not found in the list.");
 			}
 
-			delete items[i];
-
 			for (int j = i; j < size - 1; j++) {
-				items[j] = items [j + 1];
+				items[j] = items[j + 1];
 			}
 
-			items[size - 1] = nullptr;
 			size--;
 		}
 
 		// Display list
 		void PrintList() const {
 			for (int i = 0; i < size; i++) {
-				cout << *items[i] << " ";
+				cout << items[i] << " ";
 			}
 			cout << endl;
 		}
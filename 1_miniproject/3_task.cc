@@ -16,72 +16,101 @@ class ListError : public exception {
 // Defining class template
 template <typename T> class OrderedList3 {
 	private:
-		T* items[20]; // array of pointers
+		T* items; // contiguous buffer of values, with gaps
+		bool* used; // which slots of items hold a value
 		int size;
+		int capacity;
+
+		// Double the buffer, keeping every value and gap in its slot
+		void Grow() {
+			T* grown = new T[capacity * 2];
+			bool* grownUsed = new bool[capacity * 2]();
+			for (int i = 0; i < capacity; i++) {
+				grown[i] = items[i];
+				grownUsed[i] = used[i];
+			}
+			delete[] items;
+			delete[] used;
+			items = grown;
+			used = grownUsed;
+			capacity *= 2;
+		}
 
-	public:
-		OrderedList3() : size(0) {
-			for (int i = 0; i < 20; i++) {
-				items[i] = nullptr;
+		// Shift the slots after from right by one, growing first if the
+		// last slot holds a value so nothing falls off the end
+		void ShiftRight(int from) {
+			if (used[capacity - 1]) {
+				Grow();
+			}
+			for (int j = capacity - 1; j > from; j--) {
+				items[j] = items[j - 1];
+				used[j] = used[j - 1];
 			}
 		}
+
+	public:
+		OrderedList3(int initialCapacity = 20) : size(0), capacity(initialCapacity > 0 ? initialCapacity : 1) {
+			items = new T[capacity];
+			used = new bool[capacity]();
+		}
 	
 		// Destructor
 		~OrderedList3() {
-			MakeEmpty();
+			delete[] items;
+			delete[] used;
 		}
 
+		OrderedList3(const OrderedList3&) = delete;
+		OrderedList3& operator=(const OrderedList3&) = delete;
+
 		// Check if list is empty
 		bool IsEmpty() const {
 			return size == 0;
 		}
 
-		// Check if list is full
-		bool IsFull() const {
-			return size == 20;
-		}
-
 		// Remove all items
 		void MakeEmpty() {
-			for (int i=0; i < size; i++) {
-				delete items[i];
-				items[i] = nullptr;
+			for (int i = 0; i < capacity; i++) {
+				used[i] = false;
 			}
 			size = 0;
 		}
 
 		// Add item in order
 		void AddItem(const T& item) {
-		    if (IsFull()) throw ListError("List is full");
+		    if (size == capacity) Grow();
 		
 		    // Case 1: empty
 		    if (IsEmpty()) {
-		        items[0] = new T(item);
+		        items[0] = item;
+		        used[0] = true;
 		        size++;
 		        return;
 		    }
 		
 		    // Case 2: walk through to find insertion window
-		    for (int i = 0; i < 19; i++) {
-		        if (items[i] == nullptr) continue;
+		    for (int i = 0; i < capacity - 1; i++) {
+		        if (!used[i]) continue;
 		
 		        // find right neighbor
 		        int next = i + 1;
-		        while (next < 20 && items[next] == nullptr) next++;
-		        if (next >= 20 || items[next] == nullptr) break;
+		        while (next < capacity && !used[next]) next++;
+		        if (next >= capacity) break;
 		
 		        // check if item belongs here
-		        if (*items[i] < item && item < *items[next]) {
+		        if (items[i] < item && item < items[next]) {
 		            if (next > i + 1) {
 		                // gap exists, insert midpoint
 		                int mid = (i + next) / 2;
-		                items[mid] = new T(item);
+		                items[mid] = item;
+		                used[mid] = true;
 		                size++;
 		                return;
 		            } else {
 		                // contiguous, shift right once
-		                for (int j = 19; j > next; j--) items[j] = items[j - 1];
-		                items[next] = new T(item);
+		                ShiftRight(next);
+		                items[next] = item;
+		                used[next] = true;
 		                size++;
 		                return;
 		            }
@@ -89,20 +118,22 @@ template <typename T> class OrderedList3 {
 		    }
 		
 		    // Case 3: smaller than all
-		    for (int i = 0; i < 20; i++) {
-		        if (items[i] != nullptr && item < *items[i]) {
+		    for (int i = 0; i < capacity; i++) {
+		        if (used[i] && item < items[i]) {
 		            // shift right to open this slot
-		            for (int j = 19; j > i; j--) items[j] = items[j - 1];
-		            items[i] = new T(item);
+		            ShiftRight(i);
+		            items[i] = item;
+		            used[i] = true;
 		            size++;
 		            return;
 		        }
 		    }
 		
 		    // Case 4: bigger than all, put in first free spot
-		    for (int i = 0; i < 20; i++) {
-		        if (items[i] == nullptr) {
-		            items[i] = new T(item);
+		    for (int i = 0; i < capacity; i++) {
+		        if (!used[i]) {
+		            items[i] = item;
+		            used[i] = true;
 		            size++;
 		            return;
 		        }
@@ -111,10 +142,9 @@ template <typename T> class OrderedList3 {
 		
 		// Remove item
 		void RemoveItem(const T& item) {
-			for (int i = 0; i < 20; i++) {
-				if (items[i] != nullptr && *items[i] == item) {
-					delete items[i];
-					items[i] = nullptr;
+			for (int i = 0; i < capacity; i++) {
+				if (used[i] && items[i] == item) {
+					used[i] = false;
 					size--;
 					return;
 				}
@@ -124,13 +154,11 @@ template <typename T> class OrderedList3 {
 
 		// Display list
 		void PrintList() const {
-			int j = 0;
-			for (int i = 0; i < 20; i++) {
-				if (items[i] != nullptr){
-					cout << *items[i] << " ";
-					j++;
+			for (int i = 0; i < capacity; i++) {
+				if (used[i]) {
+					cout << items[i] << " ";
 				}
-			}	
+			}
 			cout << endl;
 		}
 };
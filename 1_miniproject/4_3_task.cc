@@ -5,28 +5,9 @@
 #include <ctime>
 #include <vector>
 #include <random>
+#include "ordered_lists.h"
 using namespace std;
 
-struct Counter {
-    static long comparisons;
-    static long moves;
-    static void Reset() { comparisons = moves = 0; }
-};
-
-long Counter::comparisons = 0;
-long Counter::moves = 0;
-
-// Exception class
-class ListError : public exception {
-	private:
-		string message;
-	public:
-		ListError(const string& msg) : message(msg){}
-		const char* what() const noexcept override {
-			return message.c_str();
-		}
-	};
-
 class MyItem {
     int value;
 public:
@@ -44,310 +25,12 @@ public:
     int GetValue() const { return value; }
 };
 
-// CLASS 1
-// Defining class template
-template <typename T> class OrderedList1 {
-	private:
-		T* items[50]; // array of pointers
-		int size;
-
-	public:
-		OrderedList1() : size(0) {
-			for (int i = 0; i < 50; i++) {
-				items[i] = nullptr;
-			}
-		}
-	
-		// Destructor
-		~OrderedList1() {
-			MakeEmpty();
-		}
-
-		// Check if list is empty
-		bool IsEmpty() const {
-			return size == 0;
-		}
-
-		// Check if list is full
-		bool IsFull() const {
-			return size == 50;
-		}
-
-		// Remove all items
-		void MakeEmpty() {
-			for (int i=0; i < size; i++) {
-				delete items[i];
-				items[i] = nullptr;
-			}
-			size = 0;
-		}
-
-		// Add item in order
-		void AddItem(const T& item) {
-			if (IsFull()) {
-				throw ListError("Cannot add item: list is full.");
-			}
-
-			int i = 0;
-			while (i < size && *items[i] < item) {
-				i++;
-			}
-
-			// SHR
-			for (int j = size; j > i; j--) {
-				items[j] = items[j - 1];
-				Counter::moves++;
-			}
-
-			items[i] = new T(item);
-			size++;
-		}
-
-		// Remove item
-		void RemoveItem(const T& item) {
-			int i=0;
-			while (i < size && !(*items[i] == item)) {
-				i++;
-			}
-
-			if (i == size) {
-				throw ListError("Item not found in the list.");
-			}
-
-			delete items[i];
-
-			for (int j = i; j < size - 1; j++) {
-				items[j] = items [j + 1];
-				Counter::moves++;
-			}
-
-			items[size - 1] = nullptr;
-			size--;
-		}
-
-		// Display list
-		void PrintList() const {
-			for (int i = 0; i < size; i++) {
-				cout << *items[i] << " ";
-			}
-			cout << endl;
-		}
-};
-
-// CLASS 2
-// Defining class template
-template <typename T> class OrderedList2 {
-	private:
-		T* items[50]; // array of pointers
-		int size;
-
-	public:
-		OrderedList2() : size(0) {
-			for (int i = 0; i < 50; i++) {
-				items[i] = nullptr;
-			}
-		}
-	
-		// Destructor
-		~OrderedList2() {
-			MakeEmpty();
-		}
-
-		// Check if list is empty
-		bool IsEmpty() const {
-			return size == 0;
-		}
-
-		// Check if list is full
-		bool IsFull() const {
-			return size == 50;
-		}
-
-		// Remove all items
-		void MakeEmpty() {
-			for (int i=0; i < size; i++) {
-				delete items[i];
-				items[i] = nullptr;
-			}
-			size = 0;
-		}
-
-		// Add item in order
-		void AddItem(const T& item) {
-			if (IsFull()) {
-				throw ListError("Cannot add item: list is full.");
-			}
-			
-			int i = size;
-			while (i > 0 && *items[i-1] > item) {				
-				i--;
-			}
-			// SHR
-			for (int j = size; j > i; j--) {
-				items[j] = items[j - 1];
-				Counter::moves++;
-			}
-			items[i] = new T(item);
-			size++;
-		}
-
-		// Remove item
-		void RemoveItem(const T& item) {
-			int i=0;
-			while (i < size && !(*items[i] == item)) {
-				i++;
-			}
-
-			if (i == size) {
-				throw ListError("Item not found in the list.");
-			}
-
-			delete items[i];
-
-			for (int j = i; j < size - 1; j++) {
-				items[j] = items [j + 1];
-				Counter::moves++;
-			}
-
-			items[size - 1] = nullptr;
-			size--;
-		}
-
-		// Display list
-		void PrintList() const {
-			for (int i = 0; i < size; i++) {
-				cout << *items[i] << " ";
-			}
-			cout << endl;
-		}
-};
-
-// CLASS 3
-// Defining class template
-template <typename T> class OrderedList3 {
-	private:
-		T* items[50]; // array of pointers
-		int size;
-
-	public:
-		OrderedList3() : size(0) {
-			for (int i = 0; i < 50; i++) {
-				items[i] = nullptr;
-			}
-		}
-	
-		// Destructor
-		~OrderedList3() {
-			MakeEmpty();
-		}
-
-		// Check if list is empty
-		bool IsEmpty() const {
-			return size == 0;
-		}
-
-		// Check if list is full
-		bool IsFull() const {
-			return size == 50;
-		}
-
-		// Remove all items
-		void MakeEmpty() {
-			for (int i=0; i < size; i++) {
-				delete items[i];
-				items[i] = nullptr;
-			}
-			size = 0;
-		}
-
-		// Add item in order
-		void AddItem(const T& item) {
-		    if (IsFull()) throw ListError("List is full");
-		
-		    // Case 1: empty
-		    if (IsEmpty()) {
-		        items[0] = new T(item);
-		        size++;
-		        return;
-		    }
-		
-		    // Case 2: walk through to find insertion window
-		    for (int i = 0; i < 49; i++) {
-		        if (items[i] == nullptr) continue;
-		
-		        // find right neighbor
-		        int next = i + 1;
-		        while (next < 50 && items[next] == nullptr) next++;
-		        if (next >= 50 || items[next] == nullptr) break;
-		
-		        // check if item belongs here
-		        if (*items[i] < item && item < *items[next]) {
-		            if (next > i + 1) {
-		                // gap exists, insert midpoint
-		                int mid = (i + next) / 2;
-		                items[mid] = new T(item);
-		                size++;
-		                return;
-		            } else {
-		                // contiguous, shift right once
-		                for (int j = 49; j > next; j--) items[j] = items[j - 1];
-		                items[next] = new T(item);
-		                size++;
-				Counter::moves++;
-		                return;
-		            }
-		        }
-		    }
-		
-		    // Case 3: smaller than all
-		    for (int i = 0; i < 50; i++) {
-		        if (items[i] != nullptr && item < *items[i]) {
-		            // shift right to open this slot
-		            for (int j = 49; j > i; j--) items[j] = items[j - 1];
-		            items[i] = new T(item);
-		            size++;
-			    Counter::moves++;
-		            return;
-		        }
-		    }
-		
-		    // Case 4: bigger than all, put in first free spot
-		    for (int i = 0; i < 50; i++) {
-		        if (items[i] == nullptr) {
-		            items[i] = new T(item);
-		            size++;
-		            return;
-		        }
-		    }
-		}
-		
-		// Remove item
-		void RemoveItem(const T& item) {
-			for (int i = 0; i < 50; i++) {
-				if (items[i] != nullptr && *items[i] == item) {
-					delete items[i];
-					items[i] = nullptr;
-					size--;
-					return;
-				}
-			}
-			throw ListError("Item not found in list");
-		}
-
-		// Display list
-		void PrintList() const {
-			int j = 0;
-			for (int i = 0; i < 50; i++) {
-				if (items[i] != nullptr){
-					cout << *items[i] << " ";
-					j++;
-				}
-			}	
-			cout << endl;
-		}
-};
-
 int main(){
+    if (!StaysInline<OrderedList1, 50>() || !StaysInline<OrderedList2, 50>() ||
+        !StaysInline<OrderedList3, 50>()) {
+        cout << "A list within its inline capacity allocated on the heap" << endl;
+        return 1;
+    }
     srand(time(nullptr));
     const int RUNS=100;
 
@@ -356,9 +39,9 @@ int main(){
     long totalComp3=0,totalMoves3=0;
 
     for(int run=0; run<RUNS; run++){
-        OrderedList1<MyItem> list1;
-        OrderedList2<MyItem> list2;
-        OrderedList3<MyItem> list3;
+        OrderedList1<MyItem, 50> list1;
+        OrderedList2<MyItem, 50> list2;
+        OrderedList3<MyItem, 50> list3;
 
         vector<int> inserted;
         // Insert 50 random numbers
@@ -5,28 +5,9 @@
 #include <ctime>
 #include <vector>
 #include <random>
+#include "ordered_lists.h"
 using namespace std;
 
-struct Counter {
-    static long comparisons;
-    static long moves;
-    static void Reset() { comparisons = moves = 0; }
-};
-
-long Counter::comparisons = 0;
-long Counter::moves = 0;
-
-// Exception class
-class ListError : public exception {
-	private:
-		string message;
-	public:
-		ListError(const string& msg) : message(msg){}
-		const char* what() const noexcept override {
-			return message.c_str();
-		}
-	};
-
 class MyItem {
     int value;
 public:
@@ -44,334 +25,12 @@ public:
     int GetValue() const { return value; }
 };
 
-// CLASS 1
-// Defining class template
-template <typename T> class OrderedList1 {
-	private:
-		T* items[10]; // array of pointers
-		int size;
-
-	public:
-		OrderedList1() : size(0) {
-			for (int i = 0; i < 10; i++) {
-				items[i] = nullptr;
-			}
-		}
-	
-		// Destructor
-		~OrderedList1() {
-			MakeEmpty();
-		}
-
-		// Check if list is empty
-		bool IsEmpty() const {
-			return size == 0;
-		}
-
-		// Check if list is full
-		bool IsFull() const {
-			return size == 10;
-		}
-
-		// Remove all items
-		void MakeEmpty() {
-			for (int i=0; i < size; i++) {
-				delete items[i];
-				items[i] = nullptr;
-			}
-			size = 0;
-		}
-
-		// Add item in order
-		void AddItem(const T& item) {
-			try {
-				if (IsFull()) { throw ListError("Cannot add item: list is full."); }
-			}
-			catch (const ListError&e) {
-				cout << "Caught ListError: " << e.what() << endl;
-			}
-			int i = 0;
-			while (i < size && *items[i] < item) {
-				i++;
-			}
-
-			// SHR
-			for (int j = size; j > i; j--) {
-				items[j] = items[j - 1];
-				Counter::moves++;
-			}
-
-			items[i] = new T(item);
-			size++;
-		}
-
-		// Remove item
-		void RemoveItem(const T& item) {
-			int i=0;
-			while (i < size && !(*items[i] == item)) {
-				i++;
-			}
-
-			try {
-				if (i == size) {
-					throw ListError("Item not found in the list.");
-				}
-			}
-			catch (const ListError& e) {
-				cout << "Caught ListError: " << e.what() << endl;
-			}
-			delete items[i];
-
-			for (int j = i; j < size - 1; j++) {
-				items[j] = items [j + 1];
-				Counter::moves++;
-			}
-
-			items[size - 1] = nullptr;
-			size--;
-		}
-
-		// Display list
-		void PrintList() const {
-			for (int i = 0; i < size; i++) {
-				cout << *items[i] << " ";
-			}
-			cout << endl;
-		}
-};
-
-// CLASS 2
-// Defining class template
-template <typename T> class OrderedList2 {
-	private:
-		T* items[10]; // array of pointers
-		int size;
-
-	public:
-		OrderedList2() : size(0) {
-			for (int i = 0; i < 10; i++) {
-				items[i] = nullptr;
-			}
-		}
-	
-		// Destructor
-		~OrderedList2() {
-			MakeEmpty();
-		}
-
-		// Check if list is empty
-		bool IsEmpty() const {
-			return size == 0;
-		}
-
-		// Check if list is full
-		bool IsFull() const {
-			return size == 10;
-		}
-
-		// Remove all items
-		void MakeEmpty() {
-			for (int i=0; i < size; i++) {
-				delete items[i];
-				items[i] = nullptr;
-			}
-			size = 0;
-		}
-
-		// Add item in order
-		void AddItem(const T& item) {
-			try {
-                                if (IsFull()) { throw ListError("Cannot add item: list is full."); }
-                        }
-                        catch (const ListError&e) {
-                                cout << "Caught ListError: " << e.what() << endl;
-                        }
-
-			int i = size;
-			while (i > 0 && *items[i-1] > item) {				
-				i--;
-			}
-			// SHR
-			for (int j = size; j > i; j--) {
-				items[j] = items[j - 1];
-				Counter::moves++;
-			}
-			items[i] = new T(item);
-			size++;
-		}
-
-		// Remove item
-		void RemoveItem(const T& item) {
-			int i=0;
-			while (i < size && !(*items[i] == item)) {
-				i++;
-			}
-
-			try {
-				if (i == size) {
-					throw ListError("Item not found in the list.");
-				}
-			}
-			catch (const ListError& e) {
-				cout << "Caught ListError: " << e.what() << endl;
-			}
-			delete items[i];
-
-			for (int j = i; j < size - 1; j++) {
-				items[j] = items [j + 1];
-				Counter::moves++;
-			}
-
-			items[size - 1] = nullptr;
-			size--;
-		}
-
-		// Display list
-		void PrintList() const {
-			for (int i = 0; i < size; i++) {
-				cout << *items[i] << " ";
-			}
-			cout << endl;
-		}
-};
-
-// CLASS 3
-// Defining class template
-template <typename T> class OrderedList3 {
-	private:
-		T* items[10]; // array of pointers
-		int size;
-
-	public:
-		OrderedList3() : size(0) {
-			for (int i = 0; i < 10; i++) {
-				items[i] = nullptr;
-			}
-		}
-	
-		// Destructor
-		~OrderedList3() {
-			MakeEmpty();
-		}
-
-		// Check if list is empty
-		bool IsEmpty() const {
-			return size == 0;
-		}
-
-		// Check if list is full
-		bool IsFull() const {
-			return size == 10;
-		}
-
-		// Remove all items
-		void MakeEmpty() {
-			for (int i=0; i < size; i++) {
-				delete items[i];
-				items[i] = nullptr;
-			}
-			size = 0;
-		}
-
-		// Add item in order
-		void AddItem(const T& item) {
-                        try {
-                                if (IsFull()) { throw ListError("Cannot add item: list is full."); }
-                        }
-                        catch (const ListError&e) {
-                                cout << "Caught ListError: " << e.what() << endl;
-                        }
-
-		
-		    // Case 1: empty
-		    if (IsEmpty()) {
-		        items[0] = new T(item);
-		        size++;
-		        return;
-		    }
-		
-		    // Case 2: walk through to find insertion window
-		    for (int i = 0; i < 9; i++) {
-		        if (items[i] == nullptr) continue;
-		
-		        // find right neighbor
-		        int next = i + 1;
-		        while (next < 10 && items[next] == nullptr) next++;
-		        if (next >= 10 || items[next] == nullptr) break;
-		
-		        // check if item belongs here
-		        if (*items[i] < item && item < *items[next]) {
-		            if (next > i + 1) {
-		                // gap exists, insert midpoint
-		                int mid = (i + next) / 2;
-		                items[mid] = new T(item);
-		                size++;
-		                return;
-		            } else {
-		                // contiguous, shift right once
-		                for (int j = 9; j > next; j--) items[j] = items[j - 1];
-		                items[next] = new T(item);
-		                size++;
-				Counter::moves++;
-		                return;
-		            }
-		        }
-		    }
-		
-		    // Case 3: smaller than all
-		    for (int i = 0; i < 10; i++) {
-		        if (items[i] != nullptr && item < *items[i]) {
-		            // shift right to open this slot
-		            for (int j = 9; j > i; j--) items[j] = items[j - 1];
-		            items[i] = new T(item);
-		            size++;
-			    Counter::moves++;
-		            return;
-		        }
-		    }
-		
-		    // Case 4: bigger than all, put in first free spot
-		    for (int i = 0; i < 10; i++) {
-		        if (items[i] == nullptr) {
-		            items[i] = new T(item);
-		            size++;
-		            return;
-		        }
-		    }
-		}
-		
-		// Remove item
-		void RemoveItem(const T& item) {
-			for (int i = 0; i < 10; i++) {
-				if (items[i] != nullptr && *items[i] == item) {
-					delete items[i];
-					items[i] = nullptr;
-					size--;
-					return;
-				}
-			}
-			try{
-				throw ListError("Item not found in list");
-			}
-			catch (const ListError& e) {
-				cout << "Caught ListError: " << e.what() << endl;
-			}
-		}
-
-		// Display list
-		void PrintList() const {
-			int j = 0;
-			for (int i = 0; i < 10; i++) {
-				if (items[i] != nullptr){
-					cout << *items[i] << " ";
-					j++;
-				}
-			}	
-			cout << endl;
-		}
-};
-
 int main(){
+    if (!StaysInline<OrderedList1, 10>() || !StaysInline<OrderedList2, 10>() ||
+        !StaysInline<OrderedList3, 10>()) {
+        cout << "A list within its inline capacity allocated on the heap" << endl;
+        return 1;
+    }
     srand(time(nullptr));
     const int RUNS=100;
 
@@ -380,9 +39,9 @@ int main(){
     long totalComp3=0,totalMoves3=0;
 
     for(int run=0; run<RUNS; run++){
-        OrderedList1<MyItem> list1;
-        OrderedList2<MyItem> list2;
-        OrderedList3<MyItem> list3;
+        OrderedList1<MyItem, 10> list1;
+        OrderedList2<MyItem, 10> list2;
+        OrderedList3<MyItem, 10> list3;
 
         vector<int> inserted;
         // Insert 10 random numbers
@@ -414,7 +73,9 @@ int main(){
             Counter::Reset();
             try { 
                 list1.RemoveItem(MyItem(val));
-            }catch(...){ }
+            }catch(const ListError& e){
+                cout << "Caught ListError: " << e.what() << endl;
+            }
 
             totalComp1+=Counter::comparisons; 
             totalMoves1+=Counter::moves;
@@ -422,7 +83,9 @@ int main(){
             Counter::Reset();
             try { 
                 list2.RemoveItem(MyItem(val));
-            }catch(...){ }
+            }catch(const ListError& e){
+                cout << "Caught ListError: " << e.what() << endl;
+            }
 
             totalComp2+=Counter::comparisons;
             totalMoves2+=Counter::moves;
@@ -430,7 +93,9 @@ int main(){
             Counter::Reset();
             try{
                 list3.RemoveItem(MyItem(val));
-            }catch(...){ } 
+            }catch(const ListError& e){
+                cout << "Caught ListError: " << e.what() << endl;
+            } 
 			
             totalComp3+=Counter::comparisons; 
             totalMoves3+=Counter::moves;
@@ -0,0 +1,395 @@
+#ifndef ORDERED_LISTS_H
+#define ORDERED_LISTS_H
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+struct Counter {
+    static inline long comparisons = 0;
+    static inline long moves = 0;
+    static inline long allocations = 0; // heap buffers taken by SmallArray
+    static void Reset() { comparisons = moves = 0; }
+};
+
+// Exception class
+class ListError : public std::exception {
+	private:
+		std::string message;
+	public:
+		ListError(const std::string& msg) : message(msg){}
+		const char* what() const noexcept override {
+			return message.c_str();
+		}
+	};
+
+// Array whose first N slots live inside the object itself; it only moves
+// to a heap buffer, doubling each time, once more than N are needed
+template <typename V, int N> class SmallArray {
+	static_assert(N > 0, "SmallArray needs at least one inline slot");
+
+	private:
+		V inlineValues[N];
+		V* values;
+		int capacity;
+
+	public:
+		SmallArray() : inlineValues(), values(inlineValues), capacity(N) {}
+
+		// Destructor
+		~SmallArray() {
+			if (values != inlineValues) {
+				delete[] values;
+			}
+		}
+
+		SmallArray(const SmallArray&) = delete;
+		SmallArray& operator=(const SmallArray&) = delete;
+
+		V& operator[](int i) { return values[i]; }
+		const V& operator[](int i) const { return values[i]; }
+
+		int Capacity() const {
+			return capacity;
+		}
+
+		// Double the capacity, copying the first keep values across
+		void Grow(int keep) {
+			V* grown = new V[capacity * 2]();
+			Counter::allocations++;
+			for (int i = 0; i < keep; i++) {
+				grown[i] = values[i];
+			}
+			if (values != inlineValues) {
+				delete[] values;
+			}
+			values = grown;
+			capacity *= 2;
+		}
+};
+
+// CLASS 1
+// Defining class template
+template <typename T, int N> class OrderedList1 {
+	private:
+		SmallArray<T, N> items;
+		int size;
+
+	public:
+		OrderedList1() : size(0) {}
+
+		OrderedList1(const OrderedList1&) = delete;
+		OrderedList1& operator=(const OrderedList1&) = delete;
+
+		// Check if list is empty
+		bool IsEmpty() const {
+			return size == 0;
+		}
+
+		// Remove all items
+		void MakeEmpty() {
+			size = 0;
+		}
+
+		// Add item in order
+		void AddItem(const T& item) {
+			if (size == items.Capacity()) {
+				items.Grow(size);
+			}
+
+			int i = 0;
+			while (i < size && items[i] < item) {
+				i++;
+			}
+
+			// SHR
+			for (int j = size; j > i; j--) {
+				items[j] = items[j - 1];
+				Counter::moves++;
+			}
+
+			items[i] = item;
+			size++;
+		}
+
+		// Remove item
+		void RemoveItem(const T& item) {
+			int i=0;
+			while (i < size && !(items[i] == item)) {
+				i++;
+			}
+
+			if (i == size) {
+				throw ListError("Item not found in the list.");
+			}
+
+			for (int j = i; j < size - 1; j++) {
+				items[j] = items[j + 1];
+				Counter::moves++;
+			}
+
+			size--;
+		}
+
+		// Display list
+		void PrintList() const {
+			for (int i = 0; i < size; i++) {
+				std::cout << items[i] << " ";
+			}
+			std::cout << std::endl;
+		}
+};
+
+// CLASS 2
+// Defining class template
+template <typename T, int N> class OrderedList2 {
+	private:
+		SmallArray<T, N> items;
+		int size;
+
+	public:
+		OrderedList2() : size(0) {}
+
+		OrderedList2(const OrderedList2&) = delete;
+		OrderedList2& operator=(const OrderedList2&) = delete;
+
+		// Check if list is empty
+		bool IsEmpty() const {
+			return size == 0;
+		}
+
+		// Remove all items
+		void MakeEmpty() {
+			size = 0;
+		}
+
+		// Add item in order
+		void AddItem(const T& item) {
+			if (size == items.Capacity()) {
+				items.Grow(size);
+			}
+
+			int i = size;
+			while (i > 0 && items[i-1] > item) {
+				i--;
+			}
+			// SHR
+			for (int j = size; j > i; j--) {
+				items[j] = items[j - 1];
+				Counter::moves++;
+			}
+
+			items[i] = item;
+			size++;
+		}
+
+		// Remove item
+		void RemoveItem(const T& item) {
+			int i=0;
+			while (i < size && !(items[i] == item)) {
+				i++;
+			}
+
+			if (i == size) {
+				throw ListError("Item not found in the list.");
+			}
+
+			for (int j = i; j < size - 1; j++) {
+				items[j] = items[j + 1];
+				Counter::moves++;
+			}
+
+			size--;
+		}
+
+		// Display list
+		void PrintList() const {
+			for (int i = 0; i < size; i++) {
+				std::cout << items[i] << " ";
+			}
+			std::cout << std::endl;
+		}
+};
+
+// CLASS 3
+// Defining class template
+template <typename T, int N> class OrderedList3 {
+	private:
+		SmallArray<T, N> items; // values, with gaps
+		SmallArray<bool, N> used; // which slots of items hold a value
+		int size;
+
+		int Capacity() const {
+			return items.Capacity();
+		}
+
+		// Double both arrays, keeping every value and gap in its slot
+		void Grow() {
+			int capacity = Capacity();
+			items.Grow(capacity);
+			used.Grow(capacity);
+		}
+
+		// Free a slot for a value that belongs just before slot at and
+		// return it: the gap right before at if there is one, else shift
+		// up to the nearest free slot on the right, else on the left.
+		// Only a full array has to grow
+		int OpenSlot(int at) {
+			if (at > 0 && !used[at - 1]) {
+				return at - 1;
+			}
+			int free = at;
+			while (free < Capacity() && used[free]) {
+				free++;
+			}
+			if (free == Capacity()) {
+				int left = at - 1;
+				while (left >= 0 && used[left]) {
+					left--;
+				}
+				if (left >= 0) {
+					for (int j = left; j < at - 1; j++) {
+						items[j] = items[j + 1];
+						used[j] = used[j + 1];
+					}
+					return at - 1;
+				}
+				Grow();
+			}
+			for (int j = free; j > at; j--) {
+				items[j] = items[j - 1];
+				used[j] = used[j - 1];
+			}
+			return at;
+		}
+
+	public:
+		OrderedList3() : size(0) {}
+
+		OrderedList3(const OrderedList3&) = delete;
+		OrderedList3& operator=(const OrderedList3&) = delete;
+
+		// Check if list is empty
+		bool IsEmpty() const {
+			return size == 0;
+		}
+
+		// Remove all items
+		void MakeEmpty() {
+			for (int i = 0; i < Capacity(); i++) {
+				used[i] = false;
+			}
+			size = 0;
+		}
+
+		// Add item in order
+		void AddItem(const T& item) {
+		    if (size == Capacity()) Grow();
+		    int capacity = Capacity();
+
+		    // Case 1: empty
+		    if (IsEmpty()) {
+		        items[0] = item;
+		        used[0] = true;
+		        size++;
+		        return;
+		    }
+
+		    // Case 2: walk through to find insertion window
+		    for (int i = 0; i < capacity - 1; i++) {
+		        if (!used[i]) continue;
+
+		        // find right neighbor
+		        int next = i + 1;
+		        while (next < capacity && !used[next]) next++;
+		        if (next >= capacity) break;
+
+		        // check if item belongs here
+		        if (items[i] < item && item < items[next]) {
+		            if (next > i + 1) {
+		                // gap exists, insert midpoint
+		                int mid = (i + next) / 2;
+		                items[mid] = item;
+		                used[mid] = true;
+		                size++;
+		                return;
+		            } else {
+		                // contiguous, open a slot by shifting
+		                int slot = OpenSlot(next);
+		                items[slot] = item;
+		                used[slot] = true;
+		                size++;
+		                Counter::moves++;
+		                return;
+		            }
+		        }
+		    }
+
+		    // Case 3: smaller than all
+		    for (int i = 0; i < capacity; i++) {
+		        if (used[i] && item < items[i]) {
+		            // take the gap before it or open one by shifting
+		            int slot = OpenSlot(i);
+		            items[slot] = item;
+		            used[slot] = true;
+		            size++;
+		            Counter::moves++;
+		            return;
+		        }
+		    }
+
+		    // Case 4: bigger than all, put in first free spot
+		    for (int i = 0; i < capacity; i++) {
+		        if (!used[i]) {
+		            items[i] = item;
+		            used[i] = true;
+		            size++;
+		            return;
+		        }
+		    }
+		}
+
+		// Remove item
+		void RemoveItem(const T& item) {
+			for (int i = 0; i < Capacity(); i++) {
+				if (used[i] && items[i] == item) {
+					used[i] = false;
+					size--;
+					return;
+				}
+			}
+			throw ListError("Item not found in list");
+		}
+
+		// Display list
+		void PrintList() const {
+			for (int i = 0; i < Capacity(); i++) {
+				if (used[i]) {
+					std::cout << items[i] << " ";
+				}
+			}
+			std::cout << std::endl;
+		}
+};
+
+// Fill a List<int, N> to its inline capacity, then remove values and add
+// others in their place, including below the smallest and between the two
+// largest once only the front is free. None of it may touch the heap
+template <template <typename, int> class List, int N> bool StaysInline() {
+	long before = Counter::allocations;
+	List<int, N> list;
+	for (int i = 0; i < N; i++) {
+		list.AddItem(2 * i);
+	}
+	list.RemoveItem(0);
+	list.AddItem(-1);
+	list.RemoveItem(-1);
+	list.AddItem(2 * N - 3);
+	for (int i = 1; i < N - 1; i += 2) {
+		list.RemoveItem(2 * i);
+		list.AddItem(2 * i + 1);
+	}
+	return Counter::allocations == before;
+}
+
+#endif
@@ -1,22 +1,163 @@
 #include <algorithm>
 #include <array>
+#include <cerrno>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <random>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+// GCC 12's AVX-512 headers seed results with a self-initialized
+// _mm512_undefined_epi32(), which trips -Wmaybe-uninitialized once inlined.
+// They are included here, ahead of <execution>, since TBB pulls them in too.
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+// Build with -DSORT_BENCH_PARALLEL_STL and link TBB (-ltbb) to add the
+// parallel std::sort baseline; libstdc++ runs its parallel algorithms on TBB.
+#if defined(SORT_BENCH_PARALLEL_STL) && __has_include(<execution>) && __has_include(<tbb/version.h>)
+#include <execution>
+#define SORT_BENCH_HAS_PARALLEL_STL 1
+#endif
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 namespace {
 
 using Clock = std::chrono::high_resolution_clock;
 using Duration = std::chrono::duration<double>;
-using Data = std::vector<int>;
+// Allocator for sort buffers. Buffers of at least one huge page are mapped
+// with MAP_HUGETLB when the system has reserved huge pages, otherwise as
+// ordinary 2 MiB-aligned anonymous memory with MADV_HUGEPAGE so transparent
+// huge pages can back them. Smaller buffers are cache-line aligned. The
+// policy must be chosen before the first allocation.
+struct HugePagePolicy {
+    static bool& enabled() {
+        static bool value = true;
+        return value;
+    }
+};
+
+constexpr std::size_t kHugePageBytes = std::size_t{2} << 20;
+constexpr std::size_t kCacheLineBytes = 64;
+
+std::size_t round_to_huge_page(std::size_t bytes) {
+    return (bytes + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes;
+}
+
+bool uses_huge_mapping(std::size_t bytes) {
+    return HugePagePolicy::enabled() && bytes >= kHugePageBytes;
+}
+
+void* allocate_buffer(std::size_t bytes) {
+    if (!uses_huge_mapping(bytes)) {
+        return ::operator new(bytes, std::align_val_t{kCacheLineBytes});
+    }
+    std::size_t length = round_to_huge_page(bytes);
+    void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+        return memory;
+    }
+    // Over-map by one huge page so the usable range can start on a 2 MiB
+    // boundary, then trim the slack on both sides.
+    std::size_t padded = length + kHugePageBytes;
+    void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    auto base = reinterpret_cast<std::uintptr_t>(raw);
+    std::uintptr_t aligned = (base + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes;
+    if (aligned > base) {
+        munmap(raw, aligned - base);
+    }
+    std::uintptr_t end = base + padded;
+    if (end > aligned + length) {
+        munmap(reinterpret_cast<void*>(aligned + length), end - (aligned + length));
+    }
+    madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+    return reinterpret_cast<void*>(aligned);
+}
+
+void release_buffer(void* memory, std::size_t bytes) {
+    if (!uses_huge_mapping(bytes)) {
+        ::operator delete(memory, std::align_val_t{kCacheLineBytes});
+        return;
+    }
+    munmap(memory, round_to_huge_page(bytes));
+}
+
+template <typename T>
+struct HugePageAllocator {
+    using value_type = T;
+
+    HugePageAllocator() = default;
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(allocate_buffer(n * sizeof(T))); }
+
+    void deallocate(T* memory, std::size_t n) { release_buffer(memory, n * sizeof(T)); }
+};
+
+template <typename T, typename U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+    return false;
+}
+
+using Data = std::vector<int, HugePageAllocator<int>>;
+
+// Scratch space shared by the out-of-place sorts on a thread. It is resized
+// to exactly n so sorts that swap() it with their input keep both sizes
+// consistent, and its capacity is kept between calls.
+Data& scratch_buffer(std::size_t n) {
+    static thread_local Data scratch;
+    scratch.resize(n);
+    return scratch;
+}
+
+// Per-thread staging for the fused aggregates' 64-bit totals. It only grows,
+// so repeated calls reuse pages that are already mapped.
+std::int64_t* totals_scratch(std::size_t n) {
+    static thread_local std::vector<std::int64_t, HugePageAllocator<std::int64_t>> scratch;
+    if (scratch.size() < n) {
+        scratch.resize(n);
+    }
+    return scratch.data();
+}
 
 constexpr std::array<std::size_t, 8> kRequestedSizes{
     5ull,
@@ -42,6 +183,131 @@ private:
     Clock::time_point start_;
 };
 
+// Cooperative cancellation and progress reporting for the long-running
+// sorts. Sorts report work in element units through advance(); the callbacks
+// only run once check_interval units have accumulated, so an unused control
+// costs one branch per merge, partition or radix pass.
+class SortCancelled : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct SortControl {
+    std::function<bool()> cancel_requested;
+    std::function<void(double)> on_progress;
+    std::size_t check_interval = std::size_t{1} << 16;
+
+    void begin(std::size_t total) {
+        total_work_ = total;
+        done_work_ = 0;
+        pending_work_ = 0;
+    }
+
+    void advance(std::size_t work) {
+        pending_work_ += work;
+        if (pending_work_ >= check_interval) {
+            poll();
+        }
+    }
+
+    void poll() {
+        done_work_ += pending_work_;
+        pending_work_ = 0;
+        if (on_progress && total_work_ > 0) {
+            on_progress(std::min(1.0, static_cast<double>(done_work_) / total_work_));
+        }
+        if (cancel_requested && cancel_requested()) {
+            throw SortCancelled("Sort cancelled before completion.");
+        }
+    }
+
+    void finish() {
+        if (on_progress) {
+            on_progress(1.0);
+        }
+    }
+
+private:
+    std::size_t total_work_ = 0;
+    std::size_t done_work_ = 0;
+    std::size_t pending_work_ = 0;
+};
+
+// Runs body(chunk_begin, chunk_end) over [begin, end), in pieces of at most
+// check_interval that are each reported to control, so a single O(n) loop
+// cannot hold off cancellation. Without a control it is one call.
+template <typename Body>
+void for_each_chunk(SortControl* control, std::size_t begin, std::size_t end, Body body) {
+    if (!control) {
+        body(begin, end);
+        return;
+    }
+    while (begin < end) {
+        std::size_t chunk_end = std::min(end, begin + control->check_interval);
+        body(begin, chunk_end);
+        control->advance(chunk_end - begin);
+        begin = chunk_end;
+    }
+}
+
+// Operation counters for relating wall time to algorithmic work. They are
+// only compiled in with -DSORT_BENCH_COUNT_OPS; otherwise the count_*
+// helpers are empty and counted_less/counted_swap reduce to < and std::swap.
+// Counts are per thread, so sorts that fan out to other threads or
+// processes are not covered and report n/a.
+#ifdef SORT_BENCH_COUNT_OPS
+constexpr bool kCountOps = true;
+#else
+constexpr bool kCountOps = false;
+#endif
+
+struct OpCounts {
+    std::uint64_t comparisons = 0;
+    std::uint64_t swaps = 0;
+    std::uint64_t moves = 0;
+};
+
+OpCounts& op_counts() {
+    static thread_local OpCounts counts;
+    return counts;
+}
+
+inline void count_comparisons(std::uint64_t n = 1) {
+    if constexpr (kCountOps) {
+        op_counts().comparisons += n;
+    }
+}
+
+inline void count_swaps(std::uint64_t n = 1) {
+    if constexpr (kCountOps) {
+        op_counts().swaps += n;
+    }
+}
+
+inline void count_moves(std::uint64_t n = 1) {
+    if constexpr (kCountOps) {
+        op_counts().moves += n;
+    }
+}
+
+inline bool counted_less(int lhs, int rhs) {
+    count_comparisons();
+    return lhs < rhs;
+}
+
+inline void counted_swap(int& lhs, int& rhs) {
+    count_swaps();
+    std::swap(lhs, rhs);
+}
+
+std::size_t ceil_log2(std::size_t n) {
+    std::size_t levels = 0;
+    while ((std::size_t{1} << levels) < n) {
+        ++levels;
+    }
+    return levels;
+}
+
 bool exceeds_reasonable_memory(std::size_t n, std::size_t max_bytes) {
     return n > 0 && (n > max_bytes / sizeof(int));
 }
@@ -64,15 +330,530 @@ Data generate_random_data(std::size_t n, std::mt19937_64& rng, std::size_t max_b
     return data;
 }
 
+// Radix digit histogram. Scattered increments have no SIMD form that beats
+// scalar code at 256 buckets, so this one is not dispatched per ISA.
+void digit_histogram(const int* values, std::size_t n, int shift, int mask, std::size_t* count) {
+    for (std::size_t i = 0; i < n; ++i) {
+        ++count[(values[i] >> shift) & mask];
+    }
+}
+
+// Hot kernels compiled once per instruction set and bound at startup from
+// __builtin_cpu_supports, or forced with --isa. Each *_body is written so the
+// compiler can vectorize or if-convert it for whichever target it is inlined
+// into; partition and merge have hand-written AVX2 and AVX-512 versions and
+// fall back to the scalar body elsewhere. The kernels do not feed the
+// operation counters, so their callers count for them.
+#define SORT_BENCH_INLINE inline __attribute__((always_inline))
+
+// Counts in fixed blocks of 16 so that -O2's cheap vectorizer cost model,
+// which skips loops of unknown trip count, still vectorizes the block.
+SORT_BENCH_INLINE std::size_t rank_body(const int* keys, std::size_t n, int key) {
+    std::size_t rank = 0;
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        unsigned block = 0;
+        for (std::size_t j = 0; j < 16; ++j) {
+            block += keys[i + j] < key;
+        }
+        rank += block;
+    }
+    for (; i < n; ++i) {
+        rank += keys[i] < key;
+    }
+    return rank;
+}
+
+// Branchless Lomuto partition: every element is swapped with the boundary
+// and the boundary only advances for values below the pivot.
+SORT_BENCH_INLINE std::size_t partition_body(int* values, std::size_t n, int pivot) {
+    std::size_t boundary = 0;
+    for (std::size_t j = 0; j < n; ++j) {
+        int value = values[j];
+        bool smaller = value < pivot;
+        values[j] = values[boundary];
+        values[boundary] = value;
+        boundary += smaller;
+    }
+    return boundary;
+}
+
+SORT_BENCH_INLINE void merge_body(const int* left, std::size_t left_size, const int* right,
+                                  std::size_t right_size, int* out) {
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < left_size && j < right_size) {
+        bool take_right = right[j] < left[i];
+        *out++ = take_right ? right[j] : left[i];
+        j += take_right;
+        i += !take_right;
+    }
+    out = std::copy(left + i, left + left_size, out);
+    std::copy(right + j, right + right_size, out);
+}
+
+// Packed key blocks hold kPackBlock deltas of a fixed bit width in a
+// four-lane vertical layout: delta j lives in lane j % 4 at slot j / 4, and
+// word w of lane l is stored at index 4 * w + l. Every slot then shifts all
+// four lanes by the same amount, so the x86 kernels below decode a slot
+// with one 128-bit shift pair.
+constexpr std::size_t kPackLanes = 4;
+constexpr std::size_t kPackBlock = 256;
+
+SORT_BENCH_INLINE void unpack_body(const std::uint32_t* words, int width, std::uint32_t* deltas) {
+    if (width == 0) {
+        std::fill(deltas, deltas + kPackBlock, 0u);
+        return;
+    }
+    const std::uint64_t mask = (std::uint64_t{1} << width) - 1;
+    for (std::size_t slot = 0; slot < kPackBlock / kPackLanes; ++slot) {
+        std::size_t bit = slot * static_cast<std::size_t>(width);
+        std::size_t word = bit / 32;
+        unsigned shift = static_cast<unsigned>(bit % 32);
+        const std::uint32_t* low = words + kPackLanes * word;
+        if (shift + static_cast<unsigned>(width) <= 32) {
+            for (std::size_t lane = 0; lane < kPackLanes; ++lane) {
+                deltas[kPackLanes * slot + lane] = static_cast<std::uint32_t>((low[lane] >> shift) & mask);
+            }
+        } else {
+            const std::uint32_t* high = low + kPackLanes;
+            for (std::size_t lane = 0; lane < kPackLanes; ++lane) {
+                std::uint64_t joined = (std::uint64_t{high[lane]} << 32) | low[lane];
+                deltas[kPackLanes * slot + lane] = static_cast<std::uint32_t>((joined >> shift) & mask);
+            }
+        }
+    }
+}
+
+// Static B+ tree descent: rank the query among each 16-key node's keys and
+// step to that child; the leaf level is the sorted array itself, so the
+// result is the lower-bound position. offsets[h] is where level h starts.
+constexpr std::size_t kBTreeNode = 16;
+
+SORT_BENCH_INLINE std::size_t btree_search_body(const int* tree, const std::size_t* offsets,
+                                                std::size_t height, int key) {
+    std::size_t k = 0;
+    for (std::size_t h = height - 1; h > 0; --h) {
+        std::size_t i = rank_body(tree + offsets[h] + k, kBTreeNode, key);
+        k = k * (kBTreeNode + 1) + i * kBTreeNode;
+    }
+    return k + rank_body(tree + k, kBTreeNode, key);
+}
+
+struct SortKernels {
+    const char* isa;
+    std::size_t (*rank)(const int*, std::size_t, int);
+    std::size_t (*partition)(int*, std::size_t, int);
+    void (*merge)(const int*, std::size_t, const int*, std::size_t, int*);
+    void (*unpack)(const std::uint32_t*, int, std::uint32_t*);
+    std::size_t (*btree_search)(const int*, const std::size_t*, std::size_t, int);
+};
+
+#define SORT_BENCH_DEFINE_KERNELS(suffix, target_isa)                                         \
+    __attribute__((target(target_isa))) std::size_t rank_##suffix(const int* keys,            \
+                                                                  std::size_t n, int key) {   \
+        return rank_body(keys, n, key);                                                       \
+    }                                                                                         \
+    __attribute__((target(target_isa))) std::size_t btree_search_##suffix(                    \
+        const int* tree, const std::size_t* offsets, std::size_t height, int key) {           \
+        return btree_search_body(tree, offsets, height, key);                                 \
+    }
+
+std::size_t rank_baseline(const int* keys, std::size_t n, int key) {
+    return rank_body(keys, n, key);
+}
+
+std::size_t partition_baseline(int* values, std::size_t n, int pivot) {
+    return partition_body(values, n, pivot);
+}
+
+void merge_baseline(const int* left, std::size_t left_size, const int* right,
+                    std::size_t right_size, int* out) {
+    merge_body(left, left_size, right, right_size, out);
+}
+
+void unpack_baseline(const std::uint32_t* words, int width, std::uint32_t* deltas) {
+    unpack_body(words, width, deltas);
+}
+
+std::size_t btree_search_baseline(const int* tree, const std::size_t* offsets, std::size_t height,
+                                  int key) {
+    return btree_search_body(tree, offsets, height, key);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SORT_BENCH_X86_DISPATCH 1
+#define SORT_BENCH_AVX2 "avx2,bmi2,popcnt"
+#define SORT_BENCH_AVX512 "avx512f,avx512bw,avx512vl,popcnt"
+SORT_BENCH_DEFINE_KERNELS(sse42, "sse4.2")
+SORT_BENCH_DEFINE_KERNELS(avx2, SORT_BENCH_AVX2)
+SORT_BENCH_DEFINE_KERNELS(avx512, SORT_BENCH_AVX512)
+
+// Vector unpack: each slot ORs its low word shifted right with the next
+// word shifted left and masks to the width. When a slot does not straddle
+// two words the high word's bits land above the width and are masked off,
+// so no branch is needed; the high row is clamped to the block's last row
+// so the load stays in bounds.
+__attribute__((target("sse4.2"))) void unpack_sse42(const std::uint32_t* words, int width,
+                                                    std::uint32_t* deltas) {
+    if (width == 0) {
+        std::fill(deltas, deltas + kPackBlock, 0u);
+        return;
+    }
+    const __m128i mask = _mm_set1_epi32(static_cast<int>((std::uint64_t{1} << width) - 1));
+    const std::size_t last_row = kPackBlock / 32 * static_cast<std::size_t>(width) / kPackLanes - 1;
+    for (std::size_t slot = 0; slot < kPackBlock / kPackLanes; ++slot) {
+        std::size_t bit = slot * static_cast<std::size_t>(width);
+        std::size_t row = bit / 32;
+        int shift = static_cast<int>(bit % 32);
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + kPackLanes * row));
+        __m128i high = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(words + kPackLanes * std::min(row + 1, last_row)));
+        __m128i joined = _mm_or_si128(_mm_srl_epi32(low, _mm_cvtsi32_si128(shift)),
+                                      _mm_sll_epi32(high, _mm_cvtsi32_si128(32 - shift)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(deltas + kPackLanes * slot),
+                         _mm_and_si128(joined, mask));
+    }
+}
+
+// Two slots per 256-bit register, each half with its own variable shift.
+__attribute__((target(SORT_BENCH_AVX2))) void unpack_avx2(const std::uint32_t* words, int width,
+                                                          std::uint32_t* deltas) {
+    if (width == 0) {
+        std::fill(deltas, deltas + kPackBlock, 0u);
+        return;
+    }
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>((std::uint64_t{1} << width) - 1));
+    const __m256i step = _mm256_set1_epi32(2 * width);
+    const std::size_t last_row = kPackBlock / 32 * static_cast<std::size_t>(width) / kPackLanes - 1;
+    __m256i bits = _mm256_setr_epi32(0, 0, 0, 0, width, width, width, width);
+    for (std::size_t slot = 0; slot < kPackBlock / kPackLanes; slot += 2) {
+        std::size_t row = slot * static_cast<std::size_t>(width) / 32;
+        std::size_t next_row = (slot + 1) * static_cast<std::size_t>(width) / 32;
+        __m256i low = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + kPackLanes * row))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + kPackLanes * next_row)), 1);
+        __m256i high = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                words + kPackLanes * std::min(row + 1, last_row)))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                words + kPackLanes * std::min(next_row + 1, last_row))),
+            1);
+        __m256i shift = _mm256_and_si256(bits, _mm256_set1_epi32(31));
+        __m256i joined =
+            _mm256_or_si256(_mm256_srlv_epi32(low, shift),
+                            _mm256_sllv_epi32(high, _mm256_sub_epi32(_mm256_set1_epi32(32), shift)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(deltas + kPackLanes * slot),
+                            _mm256_and_si256(joined, mask));
+        bits = _mm256_add_epi32(bits, step);
+    }
+}
+
+// Vector partition: the first and last vector are held in registers, which
+// leaves a vector's worth of free space at each end. Every step reads the
+// next vector from whichever end has less free space and writes its values
+// below the pivot to the left edge and the rest to the right edge, so writes
+// never reach unread input. Under two vectors' worth goes to the scalar body.
+struct PartitionPermutes {
+    alignas(32) std::int32_t lanes[256][8];
+};
+
+// lanes[m] moves the lanes set in m to the front and the rest behind them.
+constexpr PartitionPermutes make_partition_permutes() {
+    PartitionPermutes permutes{};
+    for (int mask = 0; mask < 256; ++mask) {
+        int next = 0;
+        for (int lane = 0; lane < 8; ++lane) {
+            if (mask & (1 << lane)) {
+                permutes.lanes[mask][next++] = lane;
+            }
+        }
+        for (int lane = 0; lane < 8; ++lane) {
+            if (!(mask & (1 << lane))) {
+                permutes.lanes[mask][next++] = lane;
+            }
+        }
+    }
+    return permutes;
+}
+
+constexpr PartitionPermutes kPartitionPermutes = make_partition_permutes();
+
+// Values left over once fewer than a vector remain unread; they are copied
+// out first because the writes may now cover them.
+SORT_BENCH_INLINE void partition_leftovers(int* first, int* last, int pivot, int*& left,
+                                           int*& right) {
+    int leftovers[16];
+    int* end = std::copy(first, last, leftovers);
+    for (int* value = leftovers; value != end; ++value) {
+        if (*value < pivot) {
+            *left++ = *value;
+        } else {
+            *--right = *value;
+        }
+    }
+}
+
+// Both stores write all eight lanes; the lanes past each side's share land
+// in free space that a later store overwrites.
+__attribute__((target(SORT_BENCH_AVX2))) SORT_BENCH_INLINE void partition_vector_avx2(
+    __m256i values, __m256i pivots, int*& left, int*& right) {
+    int smaller = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivots, values)));
+    __m256i order =
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(kPartitionPermutes.lanes[smaller]));
+    __m256i packed = _mm256_permutevar8x32_epi32(values, order);
+    int below = _mm_popcnt_u32(static_cast<unsigned>(smaller));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(left), packed);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(right - 8), packed);
+    left += below;
+    right -= 8 - below;
+}
+
+__attribute__((target(SORT_BENCH_AVX2))) std::size_t partition_avx2(int* values, std::size_t n,
+                                                                     int pivot) {
+    constexpr std::size_t lanes = 8;
+    if (n < 2 * lanes) {
+        return partition_body(values, n, pivot);
+    }
+    const __m256i pivots = _mm256_set1_epi32(pivot);
+    const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+    const __m256i last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + n - lanes));
+    int* left = values;
+    int* right = values + n;
+    int* read_left = values + lanes;
+    int* read_right = values + n - lanes;
+    while (static_cast<std::size_t>(read_right - read_left) >= lanes) {
+        const int* next;
+        if (read_left - left <= right - read_right) {
+            next = read_left;
+            read_left += lanes;
+        } else {
+            read_right -= lanes;
+            next = read_right;
+        }
+        partition_vector_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(next)), pivots,
+                              left, right);
+    }
+    partition_leftovers(read_left, read_right, pivot, left, right);
+    partition_vector_avx2(first, pivots, left, right);
+    partition_vector_avx2(last, pivots, left, right);
+    return static_cast<std::size_t>(left - values);
+}
+
+// Compress packs each side exactly; the right side is a masked store so it
+// cannot spill past the right edge.
+__attribute__((target(SORT_BENCH_AVX512))) SORT_BENCH_INLINE void partition_vector_avx512(
+    __m512i values, __m512i pivots, int*& left, int*& right) {
+    __mmask16 smaller = _mm512_cmplt_epi32_mask(values, pivots);
+    int below = _mm_popcnt_u32(smaller);
+    _mm512_storeu_si512(left, _mm512_maskz_compress_epi32(smaller, values));
+    left += below;
+    right -= 16 - below;
+    _mm512_mask_storeu_epi32(right, static_cast<__mmask16>((1u << (16 - below)) - 1),
+                             _mm512_maskz_compress_epi32(static_cast<__mmask16>(~smaller), values));
+}
+
+__attribute__((target(SORT_BENCH_AVX512))) std::size_t partition_avx512(int* values,
+                                                                         std::size_t n,
+                                                                         int pivot) {
+    constexpr std::size_t lanes = 16;
+    if (n < 2 * lanes) {
+        return partition_body(values, n, pivot);
+    }
+    const __m512i pivots = _mm512_set1_epi32(pivot);
+    const __m512i first = _mm512_loadu_si512(values);
+    const __m512i last = _mm512_loadu_si512(values + n - lanes);
+    int* left = values;
+    int* right = values + n;
+    int* read_left = values + lanes;
+    int* read_right = values + n - lanes;
+    while (static_cast<std::size_t>(read_right - read_left) >= lanes) {
+        const int* next;
+        if (read_left - left <= right - read_right) {
+            next = read_left;
+            read_left += lanes;
+        } else {
+            read_right -= lanes;
+            next = read_right;
+        }
+        partition_vector_avx512(_mm512_loadu_si512(next), pivots, left, right);
+    }
+    partition_leftovers(read_left, read_right, pivot, left, right);
+    partition_vector_avx512(first, pivots, left, right);
+    partition_vector_avx512(last, pivots, left, right);
+    return static_cast<std::size_t>(left - values);
+}
+
+// Vector merge: a bitonic network merges the carried vector of largest
+// values so far with the next vector from whichever input has the smaller
+// head, emitting the lower half. Once either input has under a vector left,
+// the carry and both remainders finish in the scalar body.
+SORT_BENCH_INLINE void merge_tail(const int* carry, std::size_t lanes, const int* left,
+                                  std::size_t left_size, const int* right, std::size_t right_size,
+                                  int* out) {
+    if (left_size < right_size) {
+        std::swap(left, right);
+        std::swap(left_size, right_size);
+    }
+    int staged[32];
+    merge_body(carry, lanes, right, right_size, staged);
+    merge_body(staged, lanes + right_size, left, left_size, out);
+}
+
+// Sorts a bitonic vector: compare-exchange at distance 4, 2 and 1.
+__attribute__((target(SORT_BENCH_AVX2))) SORT_BENCH_INLINE __m256i bitonic_clean_avx2(__m256i x) {
+    __m256i y = _mm256_permute2x128_si256(x, x, 1);
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xF0);
+    y = _mm256_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+    x = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xCC);
+    y = _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+}
+
+// Merges two sorted vectors: low gets the smaller eight, high the larger.
+__attribute__((target(SORT_BENCH_AVX2))) SORT_BENCH_INLINE void bitonic_merge_avx2(__m256i& low,
+                                                                                   __m256i& high) {
+    __m256i reversed = _mm256_permutevar8x32_epi32(high, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    high = bitonic_clean_avx2(_mm256_max_epi32(low, reversed));
+    low = bitonic_clean_avx2(_mm256_min_epi32(low, reversed));
+}
+
+__attribute__((target(SORT_BENCH_AVX2))) void merge_avx2(const int* left, std::size_t left_size,
+                                                          const int* right, std::size_t right_size,
+                                                          int* out) {
+    constexpr std::size_t lanes = 8;
+    if (left_size < lanes || right_size < lanes) {
+        merge_body(left, left_size, right, right_size, out);
+        return;
+    }
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left));
+    __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right));
+    std::size_t i = lanes;
+    std::size_t j = lanes;
+    for (;;) {
+        bitonic_merge_avx2(low, high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), low);
+        out += lanes;
+        if (i + lanes > left_size || j + lanes > right_size) {
+            break;
+        }
+        bool take_right = right[j] < left[i];
+        const int* next = take_right ? right + j : left + i;
+        j += take_right ? lanes : 0;
+        i += take_right ? 0 : lanes;
+        low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(next));
+    }
+    int carry[lanes];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(carry), high);
+    merge_tail(carry, lanes, left + i, left_size - i, right + j, right_size - j, out);
+}
+
+// Sorts a bitonic vector: compare-exchange at distance 8, 4, 2 and 1.
+__attribute__((target(SORT_BENCH_AVX512))) SORT_BENCH_INLINE __m512i
+bitonic_clean_avx512(__m512i x) {
+    __m512i y = _mm512_shuffle_i32x4(x, x, _MM_SHUFFLE(1, 0, 3, 2));
+    x = _mm512_mask_blend_epi32(0xFF00, _mm512_min_epi32(x, y), _mm512_max_epi32(x, y));
+    y = _mm512_shuffle_i32x4(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+    x = _mm512_mask_blend_epi32(0xF0F0, _mm512_min_epi32(x, y), _mm512_max_epi32(x, y));
+    y = _mm512_shuffle_epi32(x, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm512_mask_blend_epi32(0xCCCC, _mm512_min_epi32(x, y), _mm512_max_epi32(x, y));
+    y = _mm512_shuffle_epi32(x, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm512_mask_blend_epi32(0xAAAA, _mm512_min_epi32(x, y), _mm512_max_epi32(x, y));
+}
+
+__attribute__((target(SORT_BENCH_AVX512))) SORT_BENCH_INLINE void bitonic_merge_avx512(
+    __m512i& low, __m512i& high) {
+    __m512i reversed = _mm512_permutexvar_epi32(
+        _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), high);
+    high = bitonic_clean_avx512(_mm512_max_epi32(low, reversed));
+    low = bitonic_clean_avx512(_mm512_min_epi32(low, reversed));
+}
+
+__attribute__((target(SORT_BENCH_AVX512))) void merge_avx512(const int* left,
+                                                              std::size_t left_size,
+                                                              const int* right,
+                                                              std::size_t right_size, int* out) {
+    constexpr std::size_t lanes = 16;
+    if (left_size < lanes || right_size < lanes) {
+        merge_body(left, left_size, right, right_size, out);
+        return;
+    }
+    __m512i low = _mm512_loadu_si512(left);
+    __m512i high = _mm512_loadu_si512(right);
+    std::size_t i = lanes;
+    std::size_t j = lanes;
+    for (;;) {
+        bitonic_merge_avx512(low, high);
+        _mm512_storeu_si512(out, low);
+        out += lanes;
+        if (i + lanes > left_size || j + lanes > right_size) {
+            break;
+        }
+        bool take_right = right[j] < left[i];
+        const int* next = take_right ? right + j : left + i;
+        j += take_right ? lanes : 0;
+        i += take_right ? 0 : lanes;
+        low = _mm512_loadu_si512(next);
+    }
+    int carry[lanes];
+    _mm512_storeu_si512(carry, high);
+    merge_tail(carry, lanes, left + i, left_size - i, right + j, right_size - j, out);
+}
+#endif
+
+// Supported kernel sets, best last.
+std::vector<SortKernels> supported_kernels() {
+    std::vector<SortKernels> kernels{
+        {"baseline", rank_baseline, partition_baseline, merge_baseline, unpack_baseline,
+         btree_search_baseline},
+    };
+#ifdef SORT_BENCH_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        kernels.push_back({"sse4.2", rank_sse42, partition_baseline, merge_baseline,
+                           unpack_sse42, btree_search_sse42});
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") &&
+        __builtin_cpu_supports("popcnt")) {
+        kernels.push_back({"avx2", rank_avx2, partition_avx2, merge_avx2, unpack_avx2,
+                           btree_search_avx2});
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("popcnt")) {
+        kernels.push_back({"avx512", rank_avx512, partition_avx512, merge_avx512, unpack_avx2,
+                           btree_search_avx512});
+    }
+#endif
+    return kernels;
+}
+
+SortKernels& active_kernels() {
+    static SortKernels kernels = supported_kernels().back();
+    return kernels;
+}
+
+bool select_kernels(const std::string& isa) {
+    for (const SortKernels& kernels : supported_kernels()) {
+        if (isa == kernels.isa) {
+            active_kernels() = kernels;
+            return true;
+        }
+    }
+    return false;
+}
+
 void insertion_sort(Data& data) {
     for (std::size_t i = 1; i < data.size(); ++i) {
         int key = data[i];
         std::size_t j = i;
-        while (j > 0 && data[j - 1] > key) {
+        while (j > 0 && counted_less(key, data[j - 1])) {
             data[j] = data[j - 1];
+            count_moves();
             --j;
         }
         data[j] = key;
+        count_moves();
     }
 }
 
@@ -80,11 +861,11 @@ void selection_sort(Data& data) {
     for (std::size_t i = 0; i < data.size(); ++i) {
         std::size_t min_index = i;
         for (std::size_t j = i + 1; j < data.size(); ++j) {
-            if (data[j] < data[min_index]) {
+            if (counted_less(data[j], data[min_index])) {
                 min_index = j;
             }
         }
-        std::swap(data[i], data[min_index]);
+        counted_swap(data[i], data[min_index]);
     }
 }
 
@@ -93,11 +874,13 @@ void shell_sort(Data& data) {
         for (std::size_t i = gap; i < data.size(); ++i) {
             int temp = data[i];
             std::size_t j = i;
-            while (j >= gap && data[j - gap] > temp) {
+            while (j >= gap && counted_less(temp, data[j - gap])) {
                 data[j] = data[j - gap];
+                count_moves();
                 j -= gap;
             }
             data[j] = temp;
+            count_moves();
         }
     }
 }
@@ -108,15 +891,15 @@ void heapify(Data& data, std::size_t n, std::size_t i) {
         std::size_t left = 2 * i + 1;
         std::size_t right = 2 * i + 2;
 
-        if (left < n && data[left] > data[largest]) {
+        if (left < n && counted_less(data[largest], data[left])) {
             largest = left;
         }
-        if (right < n && data[right] > data[largest]) {
+        if (right < n && counted_less(data[largest], data[right])) {
             largest = right;
         }
 
         if (largest != i) {
-            std::swap(data[i], data[largest]);
+            counted_swap(data[i], data[largest]);
             i = largest;
         } else {
             break;
@@ -133,184 +916,2520 @@ void heap_sort(Data& data) {
         heapify(data, n, i - 1);
     }
     for (std::size_t i = n; i-- > 1;) {
-        std::swap(data[0], data[i]);
+        counted_swap(data[0], data[i]);
         heapify(data, i, 0);
     }
 }
 
-void merge(Data& data, Data& temp, std::size_t left, std::size_t mid, std::size_t right) {
-    std::size_t i = left;
-    std::size_t j = mid;
-    std::size_t k = left;
-    while (i < mid && j < right) {
-        if (data[i] <= data[j]) {
+// Merges from cursor until temp is filled up to end; only Bounded merges
+// check end, so a merge run in one piece pays nothing for it. The cursor is
+// passed by value so the loop keeps it in registers.
+struct MergeCursor {
+    std::size_t i;
+    std::size_t j;
+    std::size_t k;
+};
+
+template <bool Bounded>
+SORT_BENCH_INLINE MergeCursor merge_step(Data& data, Data& temp, MergeCursor at, std::size_t mid,
+                                         std::size_t right, std::size_t end) {
+    std::size_t i = at.i;
+    std::size_t j = at.j;
+    std::size_t k = at.k;
+    while ((!Bounded || k < end) && i < mid && j < right) {
+        if (!counted_less(data[j], data[i])) {
             temp[k++] = data[i++];
         } else {
             temp[k++] = data[j++];
         }
     }
-    while (i < mid) {
+    while ((!Bounded || k < end) && i < mid) {
         temp[k++] = data[i++];
     }
-    while (j < right) {
+    while ((!Bounded || k < end) && j < right) {
         temp[k++] = data[j++];
     }
+    return {i, j, k};
+}
+
+// Under a control, merges longer than check_interval run in checked chunks.
+void merge(Data& data, Data& temp, std::size_t left, std::size_t mid, std::size_t right,
+           SortControl* control = nullptr) {
+    if (control && right - left > control->check_interval) {
+        MergeCursor at{left, mid, left};
+        for_each_chunk(control, left, right, [&](std::size_t, std::size_t end) {
+            at = merge_step<true>(data, temp, at, mid, right, end);
+        });
+    } else {
+        merge_step<false>(data, temp, {left, mid, left}, mid, right, right);
+        if (control) {
+            control->advance(right - left);
+        }
+    }
     for (std::size_t idx = left; idx < right; ++idx) {
         data[idx] = temp[idx];
     }
+    count_moves(2 * (right - left));
 }
 
-void merge_sort_recursive(Data& data, Data& temp, std::size_t left, std::size_t right) {
+void merge_sort_recursive(Data& data, Data& temp, std::size_t left, std::size_t right,
+                          SortControl* control = nullptr) {
     if (right - left <= 1) {
         return;
     }
     std::size_t mid = left + (right - left) / 2;
-    merge_sort_recursive(data, temp, left, mid);
-    merge_sort_recursive(data, temp, mid, right);
-    merge(data, temp, left, mid, right);
+    merge_sort_recursive(data, temp, left, mid, control);
+    merge_sort_recursive(data, temp, mid, right, control);
+    merge(data, temp, left, mid, right, control);
 }
 
 void merge_sort(Data& data) {
-    Data temp(data.size());
+    Data& temp = scratch_buffer(data.size());
     merge_sort_recursive(data, temp, 0, data.size());
 }
 
-std::size_t median_of_three(Data& data, std::size_t low, std::size_t mid, std::size_t high) {
-    if (data[mid] < data[low]) {
-        std::swap(data[mid], data[low]);
-    }
-    if (data[high] < data[low]) {
-        std::swap(data[high], data[low]);
-    }
-    if (data[high] < data[mid]) {
-        std::swap(data[high], data[mid]);
+void merge_sort(Data& data, SortControl& control) {
+    control.begin(data.size() * ceil_log2(data.size()));
+    Data& temp = scratch_buffer(data.size());
+    merge_sort_recursive(data, temp, 0, data.size(), &control);
+    control.finish();
+}
+
+void dispatched_merge_sort_recursive(int* values, int* temp, std::size_t n) {
+    if (n <= 1) {
+        return;
     }
-    return mid;
+    std::size_t mid = n / 2;
+    dispatched_merge_sort_recursive(values, temp, mid);
+    dispatched_merge_sort_recursive(values + mid, temp + mid, n - mid);
+    // Charged as one comparison per output and a move out and back.
+    count_comparisons(n);
+    count_moves(2 * n);
+    active_kernels().merge(values, mid, values + mid, n - mid, temp);
+    std::copy(temp, temp + n, values);
 }
 
-std::size_t partition(Data& data, std::size_t low, std::size_t high) {
-    std::size_t mid = low + (high - low) / 2;
-    std::size_t pivot_index = median_of_three(data, low, mid, high);
-    std::swap(data[pivot_index], data[high]);
-    int pivot = data[high];
-    std::size_t i = low;
-    for (std::size_t j = low; j < high; ++j) {
-        if (data[j] < pivot) {
-            std::swap(data[i], data[j]);
-            ++i;
+void dispatched_merge_sort(Data& data) {
+    Data& temp = scratch_buffer(data.size());
+    dispatched_merge_sort_recursive(data.data(), temp.data(), data.size());
+}
+
+// Lazy funnelsort: split into n^(1/3) runs of n^(2/3) elements, sort each
+// recursively, then merge them through a binary k-funnel whose buffers are
+// laid out in van Emde Boas order and refilled only when they run dry.
+struct FunnelNode {
+    int* buffer;
+    std::size_t capacity;
+    int* head;
+    int* tail;
+    bool exhausted;
+};
+
+struct FunnelWorkspace {
+    std::vector<FunnelNode> nodes;
+    std::vector<std::size_t> order;
+    std::vector<std::size_t> level_capacity;
+    std::vector<std::size_t> subtree_elements;
+    std::vector<int> pool;
+};
+
+constexpr std::size_t kFunnelBaseCase = 32;
+
+void insertion_sort_range(int* first, int* last) {
+    for (int* i = first + 1; i < last; ++i) {
+        int key = *i;
+        int* j = i;
+        while (j > first && counted_less(key, *(j - 1))) {
+            *j = *(j - 1);
+            count_moves();
+            --j;
         }
+        *j = key;
+        count_moves();
     }
-    std::swap(data[i], data[high]);
-    return i;
 }
 
-void quick_sort_recursive(Data& data, std::size_t low, std::size_t high) {
-    if (low >= high) {
+void funnel_assign_levels(std::vector<std::size_t>& level_capacity, std::size_t low, std::size_t high) {
+    if (high - low <= 1) {
         return;
     }
-    std::size_t pivot_index = partition(data, low, high);
-    if (pivot_index > 0) {
-        quick_sort_recursive(data, low, pivot_index - 1);
-    }
-    quick_sort_recursive(data, pivot_index + 1, high);
+    std::size_t mid = low + (high - low + 1) / 2;
+    double inputs = static_cast<double>(1ull << (high - low));
+    level_capacity[mid] = static_cast<std::size_t>(std::ceil(inputs * std::sqrt(inputs)));
+    funnel_assign_levels(level_capacity, low, mid);
+    funnel_assign_levels(level_capacity, mid, high);
 }
 
-void quick_sort(Data& data) {
-    if (data.empty()) {
+void funnel_veb_order(std::vector<std::size_t>& order, std::size_t root, std::size_t height) {
+    if (height == 1) {
+        order.push_back(root);
         return;
     }
-    static thread_local std::mt19937 rng(std::random_device{}());
-    std::shuffle(data.begin(), data.end(), rng);
-    quick_sort_recursive(data, 0, data.size() - 1);
+    std::size_t top_height = height / 2;
+    std::size_t bottom_height = height - top_height;
+    funnel_veb_order(order, root, top_height);
+    std::size_t first_bottom = root << top_height;
+    for (std::size_t j = 0; j < (1ull << top_height); ++j) {
+        funnel_veb_order(order, first_bottom + j, bottom_height);
+    }
 }
 
-void radix_sort(Data& data) {
-    if (data.empty()) {
-        return;
-    }
-    constexpr int radix = 256;
-    constexpr int bits = 8;
-    constexpr int mask = radix - 1;
-    int max_val = *std::max_element(data.begin(), data.end());
-    Data output(data.size());
-    for (int shift = 0; (max_val >> shift) > 0; shift += bits) {
-        std::array<int, radix> count{};
-        for (int value : data) {
-            ++count[(value >> shift) & mask];
+void funnel_fill(std::vector<FunnelNode>& nodes, std::size_t index) {
+    FunnelNode& node = nodes[index];
+    FunnelNode& left = nodes[2 * index];
+    FunnelNode& right = nodes[2 * index + 1];
+    int* out = node.buffer;
+    int* out_end = node.buffer + node.capacity;
+    while (out < out_end) {
+        if (left.head == left.tail && !left.exhausted) {
+            funnel_fill(nodes, 2 * index);
         }
-        int cumulative = 0;
-        for (int i = 0; i < radix; ++i) {
-            int tmp = count[i];
-            count[i] = cumulative;
-            cumulative += tmp;
+        if (right.head == right.tail && !right.exhausted) {
+            funnel_fill(nodes, 2 * index + 1);
         }
-        for (int value : data) {
-            output[count[(value >> shift) & mask]++] = value;
+        bool left_empty = left.head == left.tail;
+        bool right_empty = right.head == right.tail;
+        if (left_empty && right_empty) {
+            break;
+        }
+        if (left_empty || right_empty) {
+            FunnelNode& source = left_empty ? right : left;
+            std::size_t count = std::min<std::size_t>(source.tail - source.head, out_end - out);
+            out = std::copy(source.head, source.head + count, out);
+            source.head += count;
+            continue;
+        }
+        while (out < out_end && left.head < left.tail && right.head < right.tail) {
+            if (!counted_less(*right.head, *left.head)) {
+                *out++ = *left.head++;
+            } else {
+                *out++ = *right.head++;
+            }
+        }
+    }
+    count_moves(out - node.buffer);
+    node.head = node.buffer;
+    node.tail = out;
+    node.exhausted = out < out_end;
+}
+
+void funnel_merge(FunnelWorkspace& ws, int* first, std::size_t run_length, std::size_t run_count,
+                  std::size_t n, int* output) {
+    std::size_t height = 0;
+    while ((1ull << height) < run_count) {
+        ++height;
+    }
+    std::size_t leaves = 1ull << height;
+
+    ws.nodes.assign(2 * leaves, FunnelNode{nullptr, 0, nullptr, nullptr, true});
+    ws.subtree_elements.assign(2 * leaves, 0);
+    for (std::size_t r = 0; r < run_count; ++r) {
+        int* begin = first + r * run_length;
+        int* end = first + std::min(n, (r + 1) * run_length);
+        ws.nodes[leaves + r] = FunnelNode{begin, static_cast<std::size_t>(end - begin), begin, end, true};
+        ws.subtree_elements[leaves + r] = end - begin;
+    }
+    for (std::size_t i = leaves; i-- > 1;) {
+        ws.subtree_elements[i] = ws.subtree_elements[2 * i] + ws.subtree_elements[2 * i + 1];
+    }
+
+    ws.level_capacity.assign(height + 1, 0);
+    funnel_assign_levels(ws.level_capacity, 0, height);
+    ws.order.clear();
+    funnel_veb_order(ws.order, 1, height);
+
+    std::size_t pool_size = 0;
+    for (std::size_t index : ws.order) {
+        if (index == 1) {
+            continue;
+        }
+        std::size_t level = 0;
+        while ((index << (level + 1)) < 2 * leaves) {
+            ++level;
+        }
+        std::size_t capacity = std::min(ws.level_capacity[level], ws.subtree_elements[index]);
+        ws.nodes[index].capacity = capacity;
+        pool_size += capacity;
+    }
+    if (ws.pool.size() < pool_size) {
+        ws.pool.resize(pool_size);
+    }
+    int* cursor = ws.pool.data();
+    for (std::size_t index : ws.order) {
+        if (index == 1) {
+            continue;
+        }
+        FunnelNode& node = ws.nodes[index];
+        node.buffer = node.head = node.tail = cursor;
+        node.exhausted = false;
+        cursor += node.capacity;
+    }
+
+    ws.nodes[1] = FunnelNode{output, n, output, output, false};
+    funnel_fill(ws.nodes, 1);
+}
+
+void funnel_sort_recursive(FunnelWorkspace& ws, int* first, std::size_t n, int* scratch) {
+    if (n <= kFunnelBaseCase) {
+        insertion_sort_range(first, first + n);
+        return;
+    }
+    std::size_t run_count = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(n))));
+    std::size_t run_length = (n + run_count - 1) / run_count;
+    run_count = (n + run_length - 1) / run_length;
+    for (std::size_t r = 0; r < run_count; ++r) {
+        std::size_t offset = r * run_length;
+        funnel_sort_recursive(ws, first + offset, std::min(run_length, n - offset), scratch + offset);
+    }
+    funnel_merge(ws, first, run_length, run_count, n, scratch);
+    std::copy(scratch, scratch + n, first);
+    count_moves(n);
+}
+
+void funnel_sort(Data& data) {
+    if (data.size() <= 1) {
+        return;
+    }
+    FunnelWorkspace ws;
+    Data& temp = scratch_buffer(data.size());
+    funnel_sort_recursive(ws, data.data(), data.size(), temp.data());
+}
+
+// Sorting networks for fixed-size std::array batches, generated at compile
+// time with Batcher's odd-even merge construction. It is within a few
+// comparators of the best known networks up to N = 32, and, unlike them,
+// exists for every N. Comparators that would touch positions past N are
+// dropped, which is the same as padding with +infinity. network_sort expands
+// the whole network inline and is usable in constant expressions.
+struct Comparator {
+    std::uint8_t low;
+    std::uint8_t high;
+};
+
+template <typename Visit>
+constexpr void odd_even_merge_network(std::size_t n, Visit visit) {
+    for (std::size_t p = 1; p < n; p <<= 1) {
+        for (std::size_t k = p; k >= 1; k >>= 1) {
+            for (std::size_t j = k % p; j + k < n; j += 2 * k) {
+                for (std::size_t i = 0; i < std::min(k, n - j - k); ++i) {
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                        visit(i + j, i + j + k);
+                    }
+                }
+            }
+        }
+    }
+}
+
+constexpr std::size_t network_size(std::size_t n) {
+    std::size_t count = 0;
+    odd_even_merge_network(n, [&count](std::size_t, std::size_t) { ++count; });
+    return count;
+}
+
+template <std::size_t N>
+constexpr std::array<Comparator, network_size(N)> make_network() {
+    static_assert(N <= 256, "comparator indices are stored in a byte");
+    std::array<Comparator, network_size(N)> network{};
+    std::size_t next = 0;
+    odd_even_merge_network(N, [&network, &next](std::size_t low, std::size_t high) {
+        network[next++] = {static_cast<std::uint8_t>(low), static_cast<std::uint8_t>(high)};
+    });
+    return network;
+}
+
+template <std::size_t N>
+inline constexpr std::array<Comparator, network_size(N)> kSortingNetwork = make_network<N>();
+
+template <typename T>
+constexpr void compare_exchange(T& lhs, T& rhs) {
+    T low = rhs < lhs ? rhs : lhs;
+    T high = rhs < lhs ? lhs : rhs;
+    lhs = low;
+    rhs = high;
+}
+
+template <typename T, std::size_t N, std::size_t... I>
+constexpr void apply_network(std::array<T, N>& values, std::index_sequence<I...>) {
+    (compare_exchange(values[kSortingNetwork<N>[I].low], values[kSortingNetwork<N>[I].high]), ...);
+}
+
+template <typename T, std::size_t N>
+constexpr void network_sort(std::array<T, N>& values) {
+    apply_network(values, std::make_index_sequence<kSortingNetwork<N>.size()>{});
+}
+
+template <std::size_t N>
+constexpr bool network_sorts_reversed() {
+    std::array<int, N> values{};
+    for (std::size_t i = 0; i < N; ++i) {
+        values[i] = static_cast<int>(N - i);
+    }
+    network_sort(values);
+    for (std::size_t i = 0; i < N; ++i) {
+        if (values[i] != static_cast<int>(i + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(network_sorts_reversed<1>() && network_sorts_reversed<7>() &&
+                  network_sorts_reversed<16>() && network_sorts_reversed<27>() &&
+                  network_sorts_reversed<32>(),
+              "sorting network failed at compile time");
+
+// K-way merge through a loser tree: tree[0] holds the overall winner and
+// tree[1..leaves) the loser of the match played at each internal node, so
+// each output element costs one leaf-to-root replay of log2(k) comparisons.
+struct MergeRun {
+    const int* head;
+    const int* tail;
+};
+
+struct LoserTree {
+    std::vector<MergeRun> runs;
+    std::vector<std::size_t> tree;
+    std::size_t leaves = 1;
+
+    bool beats(std::size_t a, std::size_t b) const {
+        if (runs[b].head == runs[b].tail) {
+            return true;
+        }
+        if (runs[a].head == runs[a].tail) {
+            return false;
+        }
+        return !counted_less(*runs[b].head, *runs[a].head);
+    }
+
+    std::size_t build(std::size_t node) {
+        if (node >= leaves) {
+            return node - leaves;
+        }
+        std::size_t left = build(2 * node);
+        std::size_t right = build(2 * node + 1);
+        if (beats(left, right)) {
+            tree[node] = right;
+            return left;
+        }
+        tree[node] = left;
+        return right;
+    }
+
+    void reset(const std::vector<MergeRun>& sources) {
+        leaves = 1;
+        while (leaves < sources.size()) {
+            leaves *= 2;
+        }
+        runs.assign(leaves, MergeRun{nullptr, nullptr});
+        std::copy(sources.begin(), sources.end(), runs.begin());
+        tree.assign(leaves, 0);
+        tree[0] = build(1);
+    }
+
+    int* merge_into(int* output) {
+        while (true) {
+            std::size_t winner = tree[0];
+            MergeRun& run = runs[winner];
+            if (run.head == run.tail) {
+                return output;
+            }
+            *output++ = *run.head++;
+            count_moves();
+            for (std::size_t node = (winner + leaves) / 2; node > 0; node /= 2) {
+                if (beats(tree[node], winner)) {
+                    std::swap(tree[node], winner);
+                }
+            }
+            tree[0] = winner;
+        }
+    }
+};
+
+int* kway_merge(LoserTree& tree, const std::vector<MergeRun>& runs, int* output) {
+    tree.reset(runs);
+    return tree.merge_into(output);
+}
+
+constexpr std::size_t kMultiwayFanIn = 16;
+constexpr std::size_t kMultiwayInitialRun = 32;
+
+void multiway_merge_sort(Data& data) {
+    const std::size_t n = data.size();
+    if (n <= 1) {
+        return;
+    }
+    for (std::size_t offset = 0; offset < n; offset += kMultiwayInitialRun) {
+        insertion_sort_range(data.data() + offset,
+                             data.data() + std::min(n, offset + kMultiwayInitialRun));
+    }
+
+    Data& temp = scratch_buffer(n);
+    int* source = data.data();
+    int* target = temp.data();
+    LoserTree tree;
+    std::vector<MergeRun> runs;
+    for (std::size_t width = kMultiwayInitialRun; width < n; width *= kMultiwayFanIn) {
+        std::size_t group = width * kMultiwayFanIn;
+        for (std::size_t start = 0; start < n; start += group) {
+            runs.clear();
+            for (std::size_t run = start; run < std::min(n, start + group); run += width) {
+                runs.push_back(MergeRun{source + run, source + std::min(n, run + width)});
+            }
+            kway_merge(tree, runs, target + start);
+        }
+        std::swap(source, target);
+    }
+    if (source != data.data()) {
+        std::copy(source, source + n, data.data());
+        count_moves(n);
+    }
+}
+
+std::size_t median_of_three(Data& data, std::size_t low, std::size_t mid, std::size_t high) {
+    if (counted_less(data[mid], data[low])) {
+        counted_swap(data[mid], data[low]);
+    }
+    if (counted_less(data[high], data[low])) {
+        counted_swap(data[high], data[low]);
+    }
+    if (counted_less(data[high], data[mid])) {
+        counted_swap(data[high], data[mid]);
+    }
+    return mid;
+}
+
+std::size_t partition(Data& data, std::size_t low, std::size_t high,
+                      SortControl* control = nullptr) {
+    std::size_t mid = low + (high - low) / 2;
+    std::size_t pivot_index = median_of_three(data, low, mid, high);
+    counted_swap(data[pivot_index], data[high]);
+    int pivot = data[high];
+    std::size_t i = low;
+    for_each_chunk(control, low, high, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t j = begin; j < end; ++j) {
+            if (counted_less(data[j], pivot)) {
+                counted_swap(data[i], data[j]);
+                ++i;
+            }
+        }
+    });
+    counted_swap(data[i], data[high]);
+    return i;
+}
+
+void quick_sort_recursive(Data& data, std::size_t low, std::size_t high,
+                          SortControl* control = nullptr) {
+    if (low >= high) {
+        return;
+    }
+    std::size_t pivot_index = partition(data, low, high, control);
+    if (pivot_index > 0) {
+        quick_sort_recursive(data, low, pivot_index - 1, control);
+    }
+    quick_sort_recursive(data, pivot_index + 1, high, control);
+}
+
+// Fisher-Yates shuffle against adversarial inputs. Under a control it runs
+// in checked chunks, since it is a full pass over the input before the
+// first partition.
+void shuffle_for_quick_sort(Data& data, SortControl* control) {
+    static thread_local std::mt19937 rng(std::random_device{}());
+    if (!control) {
+        std::shuffle(data.begin(), data.end(), rng);
+        return;
+    }
+    const std::size_t n = data.size();
+    for_each_chunk(control, 1, n, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t) {
+            std::size_t i = n - t;
+            std::uniform_int_distribution<std::size_t> pick(0, i);
+            std::swap(data[i], data[pick(rng)]);
+        }
+    });
+}
+
+void quick_sort(Data& data) {
+    if (data.empty()) {
+        return;
+    }
+    shuffle_for_quick_sort(data, nullptr);
+    quick_sort_recursive(data, 0, data.size() - 1);
+}
+
+void quick_sort(Data& data, SortControl& control) {
+    // One pass to shuffle, then about 2 n ln n of partition work for
+    // random pivots.
+    const double n = static_cast<double>(data.size());
+    control.begin(static_cast<std::size_t>(n + 2.0 * n * std::log(std::max(2.0, n))));
+    if (!data.empty()) {
+        shuffle_for_quick_sort(data, &control);
+        quick_sort_recursive(data, 0, data.size() - 1, &control);
+    }
+    control.finish();
+}
+
+void dispatched_quick_sort_recursive(Data& data, std::size_t low, std::size_t high) {
+    if (low >= high) {
+        return;
+    }
+    std::size_t mid = low + (high - low) / 2;
+    std::swap(data[median_of_three(data, low, mid, high)], data[high]);
+    int pivot = data[high];
+    // Charged as one comparison and one move per element partitioned.
+    count_comparisons(high - low);
+    count_moves(high - low);
+    std::size_t pivot_index =
+        low + active_kernels().partition(data.data() + low, high - low, pivot);
+    counted_swap(data[pivot_index], data[high]);
+    if (pivot_index > 0) {
+        dispatched_quick_sort_recursive(data, low, pivot_index - 1);
+    }
+    dispatched_quick_sort_recursive(data, pivot_index + 1, high);
+}
+
+void dispatched_quick_sort(Data& data) {
+    if (data.empty()) {
+        return;
+    }
+    static thread_local std::mt19937 rng(std::random_device{}());
+    std::shuffle(data.begin(), data.end(), rng);
+    dispatched_quick_sort_recursive(data, 0, data.size() - 1);
+}
+
+void dual_pivot_quick_sort_recursive(Data& data, std::size_t low, std::size_t high) {
+    if (low >= high) {
+        return;
+    }
+    if (counted_less(data[high], data[low])) {
+        counted_swap(data[low], data[high]);
+    }
+    int left_pivot = data[low];
+    int right_pivot = data[high];
+    std::size_t lt = low + 1;
+    std::size_t gt = high - 1;
+    std::size_t i = low + 1;
+    while (i <= gt) {
+        if (counted_less(data[i], left_pivot)) {
+            counted_swap(data[i], data[lt]);
+            ++lt;
+        } else if (counted_less(right_pivot, data[i])) {
+            while (counted_less(right_pivot, data[gt]) && i < gt) {
+                --gt;
+            }
+            counted_swap(data[i], data[gt]);
+            --gt;
+            if (counted_less(data[i], left_pivot)) {
+                counted_swap(data[i], data[lt]);
+                ++lt;
+            }
+        }
+        ++i;
+    }
+    --lt;
+    ++gt;
+    counted_swap(data[low], data[lt]);
+    counted_swap(data[high], data[gt]);
+
+    if (lt > low) {
+        dual_pivot_quick_sort_recursive(data, low, lt - 1);
+    }
+    if (left_pivot < right_pivot) {
+        dual_pivot_quick_sort_recursive(data, lt + 1, gt - 1);
+    }
+    dual_pivot_quick_sort_recursive(data, gt + 1, high);
+}
+
+void dual_pivot_quick_sort(Data& data) {
+    if (data.empty()) {
+        return;
+    }
+    static thread_local std::mt19937 rng(std::random_device{}());
+    std::shuffle(data.begin(), data.end(), rng);
+    dual_pivot_quick_sort_recursive(data, 0, data.size() - 1);
+}
+
+void radix_sort_passes(Data& data, SortControl* control) {
+    if (data.empty()) {
+        return;
+    }
+    constexpr int radix = 256;
+    constexpr int bits = 8;
+    constexpr int mask = radix - 1;
+    int max_val = *std::max_element(data.begin(), data.end());
+    Data& output = scratch_buffer(data.size());
+    const std::size_t n = data.size();
+    if (control) {
+        std::size_t passes = 0;
+        for (int shift = 0; (max_val >> shift) > 0; shift += bits) {
+            ++passes;
+        }
+        // Each pass reads the keys for the histogram and again to scatter.
+        control->begin(2 * n * passes);
+    }
+    for (int shift = 0; (max_val >> shift) > 0; shift += bits) {
+        std::array<std::size_t, radix> count{};
+        for_each_chunk(control, 0, n, [&](std::size_t begin, std::size_t end) {
+            digit_histogram(data.data() + begin, end - begin, shift, mask, count.data());
+        });
+        std::size_t cumulative = 0;
+        for (int i = 0; i < radix; ++i) {
+            std::size_t tmp = count[i];
+            count[i] = cumulative;
+            cumulative += tmp;
+        }
+        for_each_chunk(control, 0, n, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                int value = data[i];
+                output[count[(value >> shift) & mask]++] = value;
+            }
+        });
+        count_moves(n);
+        data.swap(output);
+    }
+}
+
+void radix_sort(Data& data) {
+    radix_sort_passes(data, nullptr);
+}
+
+void radix_sort(Data& data, SortControl& control) {
+    radix_sort_passes(data, &control);
+    control.finish();
+}
+
+// Sort-and-aggregate: unique keys, (key, count) runs, or per-key sums of a
+// parallel value column. Given an Aggregate, radix_sort_pairs and
+// merge_sort_pairs produce it from their final pass instead of writing the
+// sorted keys back, which saves scan_aggregate's extra pass over the output.
+// Keys must be non-negative, as for radix_sort.
+enum class AggregateKind { unique, run_lengths, group_sums };
+
+struct Aggregate {
+    AggregateKind kind;
+    Data keys;
+    std::vector<std::int64_t> totals;
+};
+
+// Distinct keys are appended to slices of a staging buffer. Each radix bucket
+// owns the slice starting at its output offset, since a bucket never holds
+// more distinct keys than values; the final merge uses a single slice.
+struct AggregateSlice {
+    std::size_t begin;
+    std::size_t end;
+};
+
+struct AggregateStaging {
+    AggregateKind kind;
+    int* keys;
+    std::int64_t* totals;
+};
+
+inline void aggregate_push(const AggregateStaging& staging, AggregateSlice& slice, int key,
+                           int value) {
+    if (slice.end == slice.begin || staging.keys[slice.end - 1] != key) {
+        staging.keys[slice.end] = key;
+        if (staging.kind != AggregateKind::unique) {
+            staging.totals[slice.end] = 0;
+        }
+        ++slice.end;
+    }
+    if (staging.kind == AggregateKind::run_lengths) {
+        ++staging.totals[slice.end - 1];
+    } else if (staging.kind == AggregateKind::group_sums) {
+        staging.totals[slice.end - 1] += value;
+    }
+}
+
+void collect_aggregate(const AggregateStaging& staging, const std::vector<AggregateSlice>& slices,
+                       Aggregate& out) {
+    out.keys.clear();
+    out.totals.clear();
+    for (const AggregateSlice& slice : slices) {
+        out.keys.insert(out.keys.end(), staging.keys + slice.begin, staging.keys + slice.end);
+        if (staging.kind != AggregateKind::unique) {
+            out.totals.insert(out.totals.end(), staging.totals + slice.begin,
+                              staging.totals + slice.end);
+        }
+    }
+}
+
+void scan_aggregate(const Data& keys, const Data& values, Aggregate& out) {
+    out.keys.clear();
+    out.totals.clear();
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (out.keys.empty() || out.keys.back() != keys[i]) {
+            out.keys.push_back(keys[i]);
+            if (out.kind != AggregateKind::unique) {
+                out.totals.push_back(0);
+            }
+        }
+        if (out.kind == AggregateKind::run_lengths) {
+            ++out.totals.back();
+        } else if (out.kind == AggregateKind::group_sums) {
+            out.totals.back() += values[i];
+        }
+    }
+}
+
+// LSD radix sort of keys carrying an optional value column (empty to sort
+// keys alone).
+void radix_sort_pairs(Data& keys, Data& values, Aggregate* fused) {
+    constexpr int radix = 256;
+    constexpr int bits = 8;
+    constexpr int mask = radix - 1;
+    const std::size_t n = keys.size();
+    const bool carry = !values.empty();
+    if (n == 0) {
+        if (fused) {
+            collect_aggregate({fused->kind, nullptr, nullptr}, {}, *fused);
+        }
+        return;
+    }
+    int max_key = *std::max_element(keys.begin(), keys.end());
+    int passes = 1;
+    while (passes * bits < std::numeric_limits<int>::digits && (max_key >> (passes * bits)) > 0) {
+        ++passes;
+    }
+    Data& key_output = scratch_buffer(n);
+    Data value_output(carry ? n : 0);
+    for (int pass = 0; pass < passes; ++pass) {
+        const int shift = pass * bits;
+        std::array<std::size_t, radix> count{};
+        digit_histogram(keys.data(), n, shift, mask, count.data());
+        std::size_t cumulative = 0;
+        for (int i = 0; i < radix; ++i) {
+            std::size_t tmp = count[i];
+            count[i] = cumulative;
+            cumulative += tmp;
+        }
+        if (fused && pass + 1 == passes) {
+            AggregateStaging staging{fused->kind, key_output.data(), totals_scratch(n)};
+            std::vector<AggregateSlice> slices(radix);
+            for (int i = 0; i < radix; ++i) {
+                slices[i] = {count[i], count[i]};
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                int key = keys[i];
+                aggregate_push(staging, slices[(key >> shift) & mask], key, carry ? values[i] : 0);
+            }
+            count_moves(n);
+            collect_aggregate(staging, slices, *fused);
+            return;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t slot = count[(keys[i] >> shift) & mask]++;
+            key_output[slot] = keys[i];
+            if (carry) {
+                value_output[slot] = values[i];
+            }
+        }
+        count_moves(n);
+        keys.swap(key_output);
+        if (carry) {
+            values.swap(value_output);
+        }
+    }
+}
+
+void merge_pairs(const int* keys, const int* values, std::size_t mid, std::size_t n, int* key_out,
+                 int* value_out) {
+    std::size_t i = 0;
+    std::size_t j = mid;
+    for (std::size_t k = 0; k < n; ++k) {
+        std::size_t from = j == n || (i < mid && !counted_less(keys[j], keys[i])) ? i++ : j++;
+        key_out[k] = keys[from];
+        if (values) {
+            value_out[k] = values[from];
+        }
+    }
+    count_moves(n);
+}
+
+void merge_sort_pairs_recursive(int* keys, int* values, int* key_temp, int* value_temp,
+                                std::size_t n) {
+    if (n <= 1) {
+        return;
+    }
+    std::size_t mid = n / 2;
+    merge_sort_pairs_recursive(keys, values, key_temp, value_temp, mid);
+    merge_sort_pairs_recursive(keys + mid, values ? values + mid : nullptr, key_temp + mid,
+                               value_temp ? value_temp + mid : nullptr, n - mid);
+    merge_pairs(keys, values, mid, n, key_temp, value_temp);
+    std::copy(key_temp, key_temp + n, keys);
+    if (values) {
+        std::copy(value_temp, value_temp + n, values);
+    }
+}
+
+void merge_sort_pairs(Data& keys, Data& values, Aggregate* fused) {
+    const std::size_t n = keys.size();
+    Data& key_temp = scratch_buffer(n);
+    Data value_temp(values.empty() ? 0 : n);
+    int* value_data = values.empty() ? nullptr : values.data();
+    if (!fused) {
+        merge_sort_pairs_recursive(keys.data(), value_data, key_temp.data(), value_temp.data(), n);
+        return;
+    }
+    std::size_t mid = n / 2;
+    if (n > 1) {
+        merge_sort_pairs_recursive(keys.data(), value_data, key_temp.data(), value_temp.data(), mid);
+        merge_sort_pairs_recursive(keys.data() + mid, value_data ? value_data + mid : nullptr,
+                                   key_temp.data() + mid, value_temp.data() + mid, n - mid);
+    }
+    AggregateStaging staging{fused->kind, key_temp.data(), totals_scratch(n)};
+    std::vector<AggregateSlice> slices(1, {0, 0});
+    std::size_t i = 0;
+    std::size_t j = mid;
+    for (std::size_t k = 0; k < n; ++k) {
+        std::size_t from = j == n || (i < mid && !counted_less(keys[j], keys[i])) ? i++ : j++;
+        aggregate_push(staging, slices[0], keys[from], value_data ? value_data[from] : 0);
+    }
+    count_moves(n);
+    collect_aggregate(staging, slices, *fused);
+}
+
+// LSD radix sort that stages each bucket's outgoing values in a cache-line
+// aligned buffer and only writes whole lines to the output, so the scatter
+// touches one line per bucket at a time instead of one per element. A
+// bucket's staged values sit at the offsets they will have within their
+// output line, so only its first flush is partial and every later flush
+// stores one aligned line. Passes whose digit is identical for every value
+// are skipped.
+template <int Bits>
+void radix_sort_buffered(Data& data) {
+    if (data.empty()) {
+        return;
+    }
+    constexpr std::size_t radix = std::size_t{1} << Bits;
+    constexpr int mask = static_cast<int>(radix - 1);
+    constexpr std::size_t line = kCacheLineBytes / sizeof(int);
+    const std::size_t n = data.size();
+    int max_val = *std::max_element(data.begin(), data.end());
+    Data& output = scratch_buffer(n);
+    std::vector<std::size_t> count(radix);
+    std::vector<std::size_t> fill(radix);
+    Data staging(radix * line);
+    for (int shift = 0; shift < std::numeric_limits<int>::digits && (max_val >> shift) > 0;
+         shift += Bits) {
+        std::fill(count.begin(), count.end(), 0);
+        digit_histogram(data.data(), n, shift, mask, count.data());
+        if (count[(data[0] >> shift) & mask] == n) {
+            continue;
+        }
+        std::size_t cumulative = 0;
+        for (std::size_t i = 0; i < radix; ++i) {
+            std::size_t tmp = count[i];
+            count[i] = cumulative;
+            fill[i] = cumulative % line;
+            cumulative += tmp;
+        }
+        for (int value : data) {
+            std::size_t bucket = (value >> shift) & mask;
+            int* slot = staging.data() + bucket * line;
+            slot[fill[bucket]++] = value;
+            if (fill[bucket] == line) {
+                std::size_t start = count[bucket] % line;
+                if (start == 0) {
+                    int* target = static_cast<int*>(
+                        __builtin_assume_aligned(output.data() + count[bucket], kCacheLineBytes));
+                    std::copy(slot, slot + line, target);
+                } else {
+                    std::copy(slot + start, slot + line, output.data() + count[bucket]);
+                }
+                count[bucket] += line - start;
+                fill[bucket] = 0;
+            }
+        }
+        for (std::size_t bucket = 0; bucket < radix; ++bucket) {
+            int* slot = staging.data() + bucket * line;
+            std::size_t start = count[bucket] % line;
+            std::copy(slot + start, slot + fill[bucket], output.data() + count[bucket]);
+        }
+        count_moves(n);
+        data.swap(output);
+    }
+}
+
+// In-place MSD radix sort (American flag sort): each bucket is permuted into
+// place by cycle-swapping values to their bucket's next free slot, then the
+// buckets are sorted recursively on the next lower digit.
+constexpr std::size_t kMsdInsertionThreshold = 32;
+
+void american_flag_sort_recursive(int* first, int* last, int shift) {
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if (n <= kMsdInsertionThreshold) {
+        insertion_sort_range(first, last);
+        return;
+    }
+    constexpr int radix = 256;
+    constexpr int bits = 8;
+    constexpr int mask = radix - 1;
+    std::array<std::size_t, radix> count{};
+    digit_histogram(first, n, shift, mask, count.data());
+    std::array<std::size_t, radix> head{};
+    std::array<std::size_t, radix> tail{};
+    std::size_t cumulative = 0;
+    for (int i = 0; i < radix; ++i) {
+        head[i] = cumulative;
+        cumulative += count[i];
+        tail[i] = cumulative;
+    }
+    for (int bucket = 0; bucket < radix; ++bucket) {
+        while (head[bucket] < tail[bucket]) {
+            int value = first[head[bucket]];
+            int digit = (value >> shift) & mask;
+            while (digit != bucket) {
+                counted_swap(value, first[head[digit]++]);
+                digit = (value >> shift) & mask;
+            }
+            first[head[bucket]++] = value;
+            count_moves();
+        }
+    }
+    if (shift == 0) {
+        return;
+    }
+    std::size_t start = 0;
+    for (int bucket = 0; bucket < radix; ++bucket) {
+        if (count[bucket] > 1) {
+            american_flag_sort_recursive(first + start, first + start + count[bucket], shift - bits);
+        }
+        start += count[bucket];
+    }
+}
+
+void american_flag_sort(Data& data) {
+    if (data.size() <= 1) {
+        return;
+    }
+    int max_val = *std::max_element(data.begin(), data.end());
+    int shift = 0;
+    while (shift + 8 < std::numeric_limits<int>::digits && (max_val >> (shift + 8)) > 0) {
+        shift += 8;
+    }
+    american_flag_sort_recursive(data.data(), data.data() + data.size(), shift);
+}
+
+// CPUs the process may run on, captured on first use, which main makes
+// before it pins the timed thread to one of them. Sorts that fan out to other
+// threads or processes widen back to this set, since those inherit the
+// mask of the thread that starts them.
+const cpu_set_t& process_cpus() {
+    static const cpu_set_t cpus = [] {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        sched_getaffinity(0, sizeof(set), &set);
+        return set;
+    }();
+    return cpus;
+}
+
+// Widens the calling thread to process_cpus() until the scope ends.
+class ProcessCpusScope {
+public:
+    ProcessCpusScope() {
+        CPU_ZERO(&saved_);
+        restore_ = sched_getaffinity(0, sizeof(saved_), &saved_) == 0 &&
+                   sched_setaffinity(0, sizeof(cpu_set_t), &process_cpus()) == 0;
+    }
+
+    ~ProcessCpusScope() {
+        if (restore_) {
+            sched_setaffinity(0, sizeof(saved_), &saved_);
+        }
+    }
+
+    ProcessCpusScope(const ProcessCpusScope&) = delete;
+    ProcessCpusScope& operator=(const ProcessCpusScope&) = delete;
+
+private:
+    cpu_set_t saved_;
+    bool restore_ = false;
+};
+
+void std_sort(Data& data) {
+    std::sort(data.begin(), data.end(), [](int lhs, int rhs) { return counted_less(lhs, rhs); });
+}
+
+void std_stable_sort(Data& data) {
+    std::stable_sort(data.begin(), data.end(), [](int lhs, int rhs) { return counted_less(lhs, rhs); });
+}
+
+#ifdef SORT_BENCH_HAS_PARALLEL_STL
+// TBB sizes its arena from the affinity of the thread that first uses it,
+// and its workers inherit that mask, so the timed thread's pin is lifted for
+// the call.
+void std_sort_par_unseq(Data& data) {
+    ProcessCpusScope all_cpus;
+    std::sort(std::execution::par_unseq, data.begin(), data.end());
+}
+#endif
+
+int compare_ints(const void* lhs, const void* rhs) {
+    int a = *static_cast<const int*>(lhs);
+    int b = *static_cast<const int*>(rhs);
+    count_comparisons();
+    return (a > b) - (a < b);
+}
+
+void c_qsort(Data& data) {
+    if (data.empty()) {
+        return;
+    }
+    std::qsort(data.data(), data.size(), sizeof(int), compare_ints);
+}
+
+// Sample sort across forked worker processes: oversampled splitters cut the
+// keys into one bucket per worker, the buckets are laid out contiguously in
+// POSIX shared memory, each child sorts its own bucket in place, and the
+// parent copies the concatenated result back. Stands in for a distributed
+// sort on a single node, with each worker isolated in its own process.
+constexpr std::size_t kSampleOversampling = 64;
+
+struct SharedMapping {
+    explicit SharedMapping(std::size_t n) : bytes(std::max<std::size_t>(n, 1) * sizeof(int)) {
+        std::string name = "/sort_bench_" + std::to_string(getpid());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("shm_open failed: ") + std::strerror(errno));
+        }
+        shm_unlink(name.c_str());
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            int error = errno;
+            close(fd);
+            throw std::runtime_error(std::string("ftruncate failed: ") + std::strerror(error));
+        }
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int error = errno;
+        close(fd);
+        if (memory == MAP_FAILED) {
+            throw std::runtime_error(std::string("mmap failed: ") + std::strerror(error));
+        }
+        values = static_cast<int*>(memory);
+    }
+
+    ~SharedMapping() { munmap(values, bytes); }
+
+    SharedMapping(const SharedMapping&) = delete;
+    SharedMapping& operator=(const SharedMapping&) = delete;
+
+    std::size_t bytes;
+    int* values = nullptr;
+};
+
+void sample_sort_processes(Data& data, std::size_t workers) {
+    const std::size_t n = data.size();
+    if (workers <= 1 || n < workers * kSampleOversampling) {
+        std_sort(data);
+        return;
+    }
+    static thread_local std::mt19937_64 rng(std::random_device{}());
+    std::vector<int> sample(workers * kSampleOversampling);
+    for (int& value : sample) {
+        value = data[rng() % n];
+    }
+    std::sort(sample.begin(), sample.end());
+    std::vector<int> splitters;
+    for (std::size_t w = 1; w < workers; ++w) {
+        splitters.push_back(sample[w * kSampleOversampling]);
+    }
+    auto bucket_of = [&splitters](int value) {
+        return static_cast<std::size_t>(
+            std::upper_bound(splitters.begin(), splitters.end(), value) - splitters.begin());
+    };
+
+    std::vector<std::size_t> offsets(workers + 1, 0);
+    for (int value : data) {
+        ++offsets[bucket_of(value) + 1];
+    }
+    for (std::size_t w = 0; w < workers; ++w) {
+        offsets[w + 1] += offsets[w];
+    }
+    SharedMapping shared(n);
+    std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (int value : data) {
+        shared.values[cursor[bucket_of(value)]++] = value;
+    }
+
+    std::vector<pid_t> children;
+    bool failed = false;
+    for (std::size_t w = 0; w < workers && !failed; ++w) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            failed = true;
+        } else if (pid == 0) {
+            // The child inherits the timed thread's single-CPU pin.
+            sched_setaffinity(0, sizeof(cpu_set_t), &process_cpus());
+            std::sort(shared.values + offsets[w], shared.values + offsets[w + 1]);
+            _exit(0);
+        } else {
+            children.push_back(pid);
+        }
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = true;
+        }
+    }
+    if (failed) {
+        throw std::runtime_error("Sample sort worker process failed.");
+    }
+    std::copy(shared.values, shared.values + n, data.begin());
+    count_moves(2 * n);
+}
+
+template <std::size_t Workers>
+void sample_sort(Data& data) {
+    sample_sort_processes(data, Workers);
+}
+
+// Indirect sorting for records too large to move cheaply: argsort() radix
+// sorts packed (key << 32 | index) pairs and returns the record order, and
+// apply_permutation() then moves every record exactly once.
+constexpr std::size_t kRecordBytes = 128;
+
+struct Record {
+    int key;
+    std::array<char, kRecordBytes - sizeof(int)> payload;
+};
+
+std::vector<std::uint32_t> argsort(const Data& keys) {
+    if (keys.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("argsort supports at most 2^32 keys.");
+    }
+    const std::size_t n = keys.size();
+    std::vector<std::uint64_t> packed(n);
+    int max_key = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        packed[i] = (static_cast<std::uint64_t>(keys[i]) << 32) | i;
+        max_key = std::max(max_key, keys[i]);
+    }
+
+    constexpr int radix = 256;
+    constexpr int bits = 8;
+    constexpr int mask = radix - 1;
+    std::vector<std::uint64_t> output(n);
+    for (int shift = 0; shift < std::numeric_limits<int>::digits && (max_key >> shift) > 0;
+         shift += bits) {
+        std::array<std::size_t, radix> count{};
+        for (std::uint64_t value : packed) {
+            ++count[(value >> (32 + shift)) & mask];
+        }
+        std::size_t cumulative = 0;
+        for (int i = 0; i < radix; ++i) {
+            std::size_t tmp = count[i];
+            count[i] = cumulative;
+            cumulative += tmp;
+        }
+        for (std::uint64_t value : packed) {
+            output[count[(value >> (32 + shift)) & mask]++] = value;
+        }
+        packed.swap(output);
+    }
+
+    std::vector<std::uint32_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        order[i] = static_cast<std::uint32_t>(packed[i]);
+    }
+    return order;
+}
+
+// Rearranges records so records[i] becomes the old records[order[i]],
+// following each cycle of the permutation with a single record of scratch.
+// Finished positions are marked in order itself, so it is consumed. The
+// source of the next move is prefetched while the current one is copied.
+void apply_permutation(std::vector<Record>& records, std::vector<std::uint32_t>& order) {
+    for (std::size_t start = 0; start < order.size(); ++start) {
+        if (order[start] == start) {
+            continue;
+        }
+        Record held = records[start];
+        std::size_t current = start;
+        while (order[current] != start) {
+            std::size_t source = order[current];
+            __builtin_prefetch(&records[order[source]]);
+            records[current] = records[source];
+            order[current] = static_cast<std::uint32_t>(current);
+            current = source;
+        }
+        records[current] = held;
+        order[current] = static_cast<std::uint32_t>(current);
+    }
+}
+
+std::vector<Record> build_records(const Data& keys) {
+    std::vector<Record> records(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        records[i].key = keys[i];
+        records[i].payload.fill(static_cast<char>(i));
+    }
+    return records;
+}
+
+void sort_records_directly(std::vector<Record>& records) {
+    std::sort(records.begin(), records.end(),
+              [](const Record& lhs, const Record& rhs) { return lhs.key < rhs.key; });
+}
+
+void sort_records_indirectly(std::vector<Record>& records) {
+    Data keys(records.size());
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        keys[i] = records[i].key;
+    }
+    std::vector<std::uint32_t> order = argsort(keys);
+    apply_permutation(records, order);
+}
+
+// Each node also carries a jump pointer to the node kListPrefetchDistance
+// places further along its list. A traversal at node i prefetches node
+// i + distance straight from node i, so the prefetch addresses never wait on
+// the chain of next pointers they are meant to hide. build_list sets the
+// jumps, merges rebuild them for their output, and insertion rotates them.
+// They are only a prefetch hint: the last few nodes of a merged run may keep
+// stale jumps.
+constexpr std::size_t kListPrefetchDistance = 16;
+
+struct ListNode {
+    int value;
+    ListNode* next;
+    ListNode* jump;
+};
+
+inline void prefetch_jump(const ListNode* node) {
+    if (node->jump) {
+        __builtin_prefetch(node->jump);
+    }
+}
+
+// The last kListPrefetchDistance nodes of a list seen so far, oldest first
+// from slot next_. append() builds an output list, making each node the jump
+// target of the oldest; visit() only records a node already in place.
+struct ListJumpRing {
+    void visit(ListNode* node) {
+        recent_[next_] = node;
+        next_ = (next_ + 1) % kListPrefetchDistance;
+    }
+
+    void append(ListNode* node) {
+        if (recent_[next_]) {
+            recent_[next_]->jump = node;
+        }
+        visit(node);
+    }
+
+    // For node inserted right after the newest entry: every entry's jump moves
+    // one node back along the list, and node takes over the newest's old one.
+    void insert_after_newest(ListNode* node) {
+        ListNode* carry = node;
+        for (std::size_t i = 0; i < kListPrefetchDistance; ++i) {
+            std::swap(recent_[(next_ + i) % kListPrefetchDistance]->jump, carry);
+        }
+        node->jump = carry;
+    }
+
+    void reset(ListNode* leads) {
+        for (std::size_t i = 0; i < kListPrefetchDistance; ++i) {
+            recent_[i] = &leads[i];
+        }
+        next_ = 0;
+    }
+
+private:
+    std::array<ListNode*, kListPrefetchDistance> recent_{};
+    std::size_t next_ = 0;
+};
+
+// With Prefetch, leads[j].jump is the sorted list's j-th node: the leads act
+// as kListPrefetchDistance virtual nodes ahead of the head, so an insertion
+// near the front shifts jumps exactly like one further along.
+template <bool Prefetch>
+ListNode* list_insertion_sort(ListNode* head) {
+    ListNode dummy{0, nullptr, nullptr};
+    std::array<ListNode, kListPrefetchDistance> leads{};
+    ListJumpRing ring;
+    ListNode* current = head;
+    while (current) {
+        ListNode* next = current->next;
+        ListNode* prev = &dummy;
+        if constexpr (Prefetch) {
+            ring.reset(leads.data());
+        }
+        while (prev->next && prev->next->value < current->value) {
+            prev = prev->next;
+            if constexpr (Prefetch) {
+                prefetch_jump(prev);
+                ring.visit(prev);
+            }
+        }
+        if constexpr (Prefetch) {
+            ring.insert_after_newest(current);
+        }
+        current->next = prev->next;
+        prev->next = current;
+        current = next;
+    }
+    return dummy.next;
+}
+
+template <bool Prefetch>
+ListNode* merge_lists(ListNode* left, ListNode* right) {
+    ListNode dummy{0, nullptr, nullptr};
+    ListNode* tail = &dummy;
+    ListJumpRing ring;
+    while (left && right) {
+        ListNode* taken;
+        if (left->value <= right->value) {
+            taken = left;
+            left = left->next;
+        } else {
+            taken = right;
+            right = right->next;
+        }
+        if constexpr (Prefetch) {
+            prefetch_jump(taken);
+            ring.append(taken);
+        }
+        tail->next = taken;
+        tail = taken;
+    }
+    tail->next = left ? left : right;
+    return dummy.next;
+}
+
+// Bottom-up merge sort: bins[i] holds a sorted run of 2^i nodes, and each
+// node carries into the bins like incrementing a binary counter, so no pass
+// is needed to measure or split the list.
+template <bool Prefetch>
+ListNode* list_merge_sort(ListNode* head) {
+    constexpr std::size_t kMaxBins = 64;
+    std::array<ListNode*, kMaxBins> bins{};
+    std::size_t used = 0;
+    while (head) {
+        ListNode* run = head;
+        head = head->next;
+        run->next = nullptr;
+        std::size_t i = 0;
+        for (; i < used && bins[i]; ++i) {
+            run = merge_lists<Prefetch>(bins[i], run);
+            bins[i] = nullptr;
+        }
+        if (i == used) {
+            ++used;
+        }
+        bins[i] = run;
+    }
+    ListNode* result = nullptr;
+    for (std::size_t i = 0; i < used; ++i) {
+        result = bins[i] ? merge_lists<Prefetch>(bins[i], result) : result;
+    }
+    return result;
+}
+
+template <bool Prefetch>
+const ListNode* list_find(const ListNode* head, int value) {
+    while (head && head->value != value) {
+        if constexpr (Prefetch) {
+            prefetch_jump(head);
+        }
+        head = head->next;
+    }
+    return head;
+}
+
+// slots[i] is the arena index of the i-th node in list order; leaving it
+// empty lays the nodes out sequentially.
+struct ListArena {
+    std::vector<ListNode> nodes;
+    std::vector<std::size_t> slots;
+};
+
+void shuffle_list_layout(ListArena& arena, std::size_t n, std::mt19937_64& rng) {
+    arena.slots.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        arena.slots[i] = i;
+    }
+    std::shuffle(arena.slots.begin(), arena.slots.end(), rng);
+}
+
+ListNode* build_list(const Data& data, ListArena& arena) {
+    arena.nodes.resize(data.size());
+    auto slot = [&arena](std::size_t i) {
+        return &arena.nodes[arena.slots.empty() ? i : arena.slots[i]];
+    };
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        std::size_t ahead = i + kListPrefetchDistance;
+        *slot(i) = ListNode{data[i], i + 1 < data.size() ? slot(i + 1) : nullptr,
+                            ahead < data.size() ? slot(ahead) : nullptr};
+    }
+    return data.empty() ? nullptr : slot(0);
+}
+
+void free_list(ListArena& arena) {
+    arena.nodes.clear();
+}
+
+// True when the list holds exactly n values in non-decreasing order.
+bool list_is_sorted(const ListNode* list, std::size_t n) {
+    std::size_t count = 0;
+    for (const ListNode* node = list; node; node = node->next) {
+        if (node->next && node->next->value < node->value) {
+            return false;
+        }
+        ++count;
+    }
+    return count == n;
+}
+
+// Lookups against the sorted output, all returning lower-bound positions.
+// windowed_lower_bound() binary searches down to a small window and finishes
+// with the dispatched rank kernel, which counts the window's keys below the
+// query without branching. The other two search static layouts built from
+// the sorted keys: the Eytzinger layout stores the implicit search tree in
+// breadth-first order, so a descent touches few lines near the root and can
+// prefetch the 16 descendants four levels down as one cache line; the S+ tree
+// packs 16 keys per cache-line node with 17 children, over the sorted keys
+// padded to whole nodes, and searches each node with the rank kernel.
+constexpr std::size_t kRankWindow = 64;
+constexpr std::size_t kSearchQueries = std::size_t{1} << 22;
+
+// Learned index: a piecewise-linear map from key to position whose error is
+// at most kLearnedEpsilon everywhere, fitted in one pass with a shrinking
+// cone (each segment keeps the range of slopes through its first point that
+// still fit every later point, and closes when the range empties). Segments
+// are found RadixSpline-style through a table indexed by the top key bits,
+// with about four entries per segment up to 2^kLearnedRadixBits, and the last
+// mile is a rank over the 2 * epsilon window around the prediction.
+// Duplicates can push a lower bound outside the window, so an answer on the
+// window's edge falls back to a binary search beyond it.
+constexpr std::size_t kLearnedEpsilon = 32;
+constexpr std::size_t kLearnedRadixBits = 16;
+
+struct LearnedSegment {
+    int first_key;
+    double slope;
+    std::size_t first_position;
+};
+
+struct LearnedIndex {
+    std::vector<LearnedSegment> segments;
+    std::vector<std::uint32_t> radix_table;
+    int min_key = 0;
+    int shift = 0;
+
+    std::size_t bytes() const {
+        return segments.size() * sizeof(LearnedSegment) +
+               radix_table.size() * sizeof(std::uint32_t);
+    }
+};
+
+std::size_t learned_prefix(const LearnedIndex& index, int key) {
+    std::int64_t offset = static_cast<std::int64_t>(key) - index.min_key;
+    if (offset < 0) {
+        return 0;
+    }
+    return std::min(static_cast<std::size_t>(offset >> index.shift), index.radix_table.size() - 2);
+}
+
+LearnedIndex build_learned_index(const Data& sorted) {
+    LearnedIndex index;
+    if (sorted.empty()) {
+        return index;
+    }
+    const double epsilon = static_cast<double>(kLearnedEpsilon);
+    LearnedSegment current{sorted[0], 0.0, 0};
+    double slope_low = 0.0;
+    double slope_high = std::numeric_limits<double>::infinity();
+    for (std::size_t i = 1; i < sorted.size(); ++i) {
+        if (sorted[i] == sorted[i - 1]) {
+            continue;
+        }
+        double dx = static_cast<double>(static_cast<std::int64_t>(sorted[i]) - current.first_key);
+        double dy = static_cast<double>(i - current.first_position);
+        double low = std::max(slope_low, (dy - epsilon) / dx);
+        double high = std::min(slope_high, (dy + epsilon) / dx);
+        if (low > high) {
+            current.slope = std::isinf(slope_high) ? 0.0 : (slope_low + slope_high) / 2;
+            index.segments.push_back(current);
+            current = {sorted[i], 0.0, i};
+            slope_low = 0.0;
+            slope_high = std::numeric_limits<double>::infinity();
+        } else {
+            slope_low = low;
+            slope_high = high;
+        }
+    }
+    current.slope = std::isinf(slope_high) ? 0.0 : (slope_low + slope_high) / 2;
+    index.segments.push_back(current);
+
+    index.min_key = sorted.front();
+    std::uint64_t span = static_cast<std::uint64_t>(static_cast<std::int64_t>(sorted.back()) -
+                                                    sorted.front());
+    const std::size_t radix_bits =
+        std::min<std::size_t>(kLearnedRadixBits, ceil_log2(index.segments.size()) + 2);
+    while ((span >> index.shift) >= (std::uint64_t{1} << radix_bits)) {
+        ++index.shift;
+    }
+    std::size_t buckets = static_cast<std::size_t>(span >> index.shift) + 1;
+    index.radix_table.assign(buckets + 1, 0);
+    std::size_t next = 0;
+    for (std::size_t prefix = 0; prefix <= buckets; ++prefix) {
+        while (next < index.segments.size() &&
+               learned_prefix(index, index.segments[next].first_key) < prefix) {
+            ++next;
+        }
+        index.radix_table[prefix] = static_cast<std::uint32_t>(next);
+    }
+    return index;
+}
+
+struct SearchLayouts {
+    const Data* sorted = nullptr;
+    Data eytzinger;
+    std::vector<std::uint32_t> eytzinger_rank;
+    Data btree;
+    std::vector<std::size_t> btree_offsets;
+    LearnedIndex learned;
+};
+
+// Sorted keys, the two layouts and the Eytzinger ranks.
+constexpr std::size_t kSearchLayoutBytesPerKey = 4 * sizeof(int) + sizeof(std::uint32_t);
+
+std::size_t fill_eytzinger(SearchLayouts& layouts, std::size_t i, std::size_t k) {
+    if (k < layouts.eytzinger.size()) {
+        i = fill_eytzinger(layouts, i, 2 * k);
+        layouts.eytzinger[k] = (*layouts.sorted)[i];
+        layouts.eytzinger_rank[k] = static_cast<std::uint32_t>(i);
+        i = fill_eytzinger(layouts, i + 1, 2 * k + 1);
+    }
+    return i;
+}
+
+std::size_t btree_blocks(std::size_t keys) {
+    return (keys + kBTreeNode - 1) / kBTreeNode;
+}
+
+std::size_t btree_parent_keys(std::size_t keys) {
+    return (btree_blocks(keys) + kBTreeNode) / (kBTreeNode + 1) * kBTreeNode;
+}
+
+void build_btree(SearchLayouts& layouts) {
+    const Data& sorted = *layouts.sorted;
+    const std::size_t n = sorted.size();
+    std::size_t total = 0;
+    std::size_t level_keys = n;
+    layouts.btree_offsets.clear();
+    while (true) {
+        layouts.btree_offsets.push_back(total);
+        total += btree_blocks(level_keys) * kBTreeNode;
+        if (level_keys <= kBTreeNode) {
+            break;
+        }
+        level_keys = btree_parent_keys(level_keys);
+    }
+    Data& tree = layouts.btree;
+    tree.assign(std::max(total, kBTreeNode), std::numeric_limits<int>::max());
+    std::copy(sorted.begin(), sorted.end(), tree.begin());
+    const std::size_t height = layouts.btree_offsets.size();
+    for (std::size_t h = 1; h < height; ++h) {
+        std::size_t level_end = h + 1 < height ? layouts.btree_offsets[h + 1] : total;
+        for (std::size_t i = 0; i < level_end - layouts.btree_offsets[h]; ++i) {
+            // Key j of a node separates children j and j + 1: it is the first
+            // leaf key under child j + 1.
+            std::size_t k = (i / kBTreeNode) * (kBTreeNode + 1) + i % kBTreeNode + 1;
+            for (std::size_t level = 1; level < h; ++level) {
+                k *= kBTreeNode + 1;
+            }
+            tree[layouts.btree_offsets[h] + i] =
+                k * kBTreeNode < n ? tree[k * kBTreeNode] : std::numeric_limits<int>::max();
+        }
+    }
+}
+
+SearchLayouts build_search_layouts(const Data& sorted) {
+    if (sorted.size() >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("search layouts support fewer than 2^32 keys.");
+    }
+    SearchLayouts layouts;
+    layouts.sorted = &sorted;
+    layouts.eytzinger.assign(sorted.size() + 1, 0);
+    layouts.eytzinger_rank.assign(sorted.size() + 1, 0);
+    fill_eytzinger(layouts, 0, 1);
+    build_btree(layouts);
+    layouts.learned = build_learned_index(sorted);
+    return layouts;
+}
+
+std::size_t std_lower_bound(const SearchLayouts& layouts, int key) {
+    const Data& sorted = *layouts.sorted;
+    return static_cast<std::size_t>(std::lower_bound(sorted.begin(), sorted.end(), key) -
+                                    sorted.begin());
+}
+
+std::size_t windowed_lower_bound(const SearchLayouts& layouts, int key) {
+    const Data& sorted = *layouts.sorted;
+    std::size_t low = 0;
+    std::size_t high = sorted.size();
+    while (high - low > kRankWindow) {
+        std::size_t mid = low + (high - low) / 2;
+        if (sorted[mid] < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low + active_kernels().rank(sorted.data() + low, high - low, key);
+}
+
+std::size_t eytzinger_lower_bound(const SearchLayouts& layouts, int key) {
+    const int* tree = layouts.eytzinger.data();
+    const std::size_t n = layouts.eytzinger.size() - 1;
+    std::size_t k = 1;
+    while (k <= n) {
+        __builtin_prefetch(tree + std::min(k * 16, n));
+        k = 2 * k + (tree[k] < key);
+    }
+    // Undo the right turns taken after the last left turn, whose node is the
+    // answer; k becomes 0 when every key is smaller than the query.
+    k >>= __builtin_ffsll(static_cast<long long>(~k));
+    return k == 0 ? n : layouts.eytzinger_rank[k];
+}
+
+std::size_t btree_lower_bound(const SearchLayouts& layouts, int key) {
+    std::size_t position =
+        active_kernels().btree_search(layouts.btree.data(), layouts.btree_offsets.data(),
+                                      layouts.btree_offsets.size(), key);
+    return std::min(position, layouts.sorted->size());
+}
+
+std::size_t learned_lower_bound(const SearchLayouts& layouts, int key) {
+    const Data& sorted = *layouts.sorted;
+    const LearnedIndex& index = layouts.learned;
+    const std::size_t n = sorted.size();
+    std::size_t prefix = learned_prefix(index, key);
+    auto first = index.segments.begin() + std::max<std::uint32_t>(index.radix_table[prefix], 1) - 1;
+    auto last = index.segments.begin() + index.radix_table[prefix + 1];
+    auto segment = std::upper_bound(first, last, key, [](int value, const LearnedSegment& s) {
+        return value < s.first_key;
+    });
+    if (segment != index.segments.begin()) {
+        --segment;
+    }
+    double offset = static_cast<double>(static_cast<std::int64_t>(key) - segment->first_key);
+    double predicted = static_cast<double>(segment->first_position) + segment->slope * offset;
+    std::size_t guess = predicted <= 0.0 ? 0 : std::min(static_cast<std::size_t>(predicted), n);
+    std::size_t low = guess > kLearnedEpsilon ? guess - kLearnedEpsilon : 0;
+    std::size_t high = std::min(guess + kLearnedEpsilon + 2, n);
+    std::size_t position = low + active_kernels().rank(sorted.data() + low, high - low, key);
+    if (position == low && low > 0 && sorted[low - 1] >= key) {
+        return static_cast<std::size_t>(
+            std::lower_bound(sorted.begin(), sorted.begin() + low, key) - sorted.begin());
+    }
+    if (position == high && high < n) {
+        return static_cast<std::size_t>(
+            std::lower_bound(sorted.begin() + high, sorted.end(), key) - sorted.begin());
+    }
+    return position;
+}
+
+struct SearchDefinition {
+    std::string name;
+    std::size_t (*search_fn)(const SearchLayouts&, int);
+};
+
+const std::vector<SearchDefinition> kSearches{
+    {"Sorted Search (std::lower_bound)", std_lower_bound},
+    {"Sorted Search (binary + rank kernel)", windowed_lower_bound},
+    {"Sorted Search (Eytzinger + prefetch)", eytzinger_lower_bound},
+    {"Sorted Search (S+ tree, 16-key nodes)", btree_lower_bound},
+    {"Sorted Search (learned index)", learned_lower_bound},
+};
+
+// Random single-key reads from the packed output.
+constexpr std::size_t kPackedReads = std::size_t{1} << 16;
+
+// Compact on-disk form of sorted keys, in the style of patched frame-of-
+// reference (PFor): each block of kPackBlock keys keeps its first key, bit
+// width and exception count in an index entry and stores the gaps between
+// neighbours bit-packed at that width. The width is chosen so the rare large
+// gaps do not widen the whole block; they become exceptions whose high bits
+// follow the packed words, one word each, then their positions four to a
+// word. Keys drawn from [0, 2n] have gaps of about two and pack to a little
+// over four bits each, index included. The index gives random access to any
+// block without decoding the ones before it.
+struct PackedBlock {
+    int first;
+    std::uint16_t width;
+    std::uint16_t exceptions;
+    std::uint64_t offset;
+};
+
+std::size_t packed_delta_words(std::size_t width) {
+    return kPackBlock / 32 * width;
+}
+
+std::size_t packed_block_words(std::size_t width, std::size_t exceptions) {
+    return packed_delta_words(width) + exceptions + (exceptions + 3) / 4;
+}
+
+struct PackedKeys {
+    std::uint64_t size = 0;
+    std::vector<PackedBlock> index;
+    std::vector<std::uint32_t> words;
+
+    std::size_t bytes() const {
+        return index.size() * sizeof(PackedBlock) + words.size() * sizeof(std::uint32_t);
+    }
+};
+
+constexpr char kPackedMagic[4] = {'S', 'B', 'P', 'K'};
+
+PackedKeys pack_sorted(const Data& sorted) {
+    PackedKeys packed;
+    packed.size = sorted.size();
+    std::array<std::uint32_t, kPackBlock> deltas{};
+    for (std::size_t start = 0; start < sorted.size(); start += kPackBlock) {
+        std::size_t count = std::min(kPackBlock, sorted.size() - start);
+        std::array<std::size_t, 33> at_width{};
+        for (std::size_t j = 0; j < kPackBlock; ++j) {
+            deltas[j] = j == 0 || j >= count ? 0u
+                                             : static_cast<std::uint32_t>(sorted[start + j]) -
+                                                   static_cast<std::uint32_t>(sorted[start + j - 1]);
+            std::size_t bits = 0;
+            while (bits < 32 && (deltas[j] >> bits) != 0) {
+                ++bits;
+            }
+            ++at_width[bits];
+        }
+        std::size_t width = 32;
+        std::size_t exceptions = 0;
+        std::size_t wider = 0;
+        for (std::size_t candidate = 32; candidate-- > 0;) {
+            wider += at_width[candidate + 1];
+            if (packed_block_words(candidate, wider) <= packed_block_words(width, exceptions)) {
+                width = candidate;
+                exceptions = wider;
+            }
+        }
+        std::size_t base = packed.words.size();
+        packed.index.push_back({sorted[start], static_cast<std::uint16_t>(width),
+                                static_cast<std::uint16_t>(exceptions), base});
+        packed.words.resize(base + packed_block_words(width, exceptions), 0u);
+        std::uint32_t* exception_high = packed.words.data() + base + packed_delta_words(width);
+        std::uint32_t* exception_positions = exception_high + exceptions;
+        std::size_t exception = 0;
+        for (std::size_t j = 0; j < kPackBlock; ++j) {
+            std::uint32_t delta = deltas[j];
+            if (width < 32 && (delta >> width) != 0) {
+                exception_high[exception] = delta >> width;
+                exception_positions[exception / 4] |= static_cast<std::uint32_t>(j)
+                                                      << (8 * (exception % 4));
+                ++exception;
+                delta &= (std::uint32_t{1} << width) - 1;
+            }
+            if (width == 0) {
+                continue;
+            }
+            std::size_t bit = (j / kPackLanes) * width;
+            std::size_t word = base + kPackLanes * (bit / 32) + j % kPackLanes;
+            unsigned shift = static_cast<unsigned>(bit % 32);
+            packed.words[word] |= delta << shift;
+            if (shift + width > 32) {
+                packed.words[word + kPackLanes] |= delta >> (32 - shift);
+            }
+        }
+    }
+    return packed;
+}
+
+// Decodes block b into out, which must have room for kPackBlock keys.
+void unpack_block(const PackedKeys& packed, std::size_t b, int* out) {
+    const PackedBlock& block = packed.index[b];
+    std::array<std::uint32_t, kPackBlock> deltas;
+    const std::uint32_t* words = packed.words.data() + block.offset;
+    active_kernels().unpack(words, static_cast<int>(block.width), deltas.data());
+    const std::uint32_t* exception_high = words + packed_delta_words(block.width);
+    const std::uint32_t* exception_positions = exception_high + block.exceptions;
+    for (std::size_t e = 0; e < block.exceptions; ++e) {
+        std::size_t j = (exception_positions[e / 4] >> (8 * (e % 4))) & 0xff;
+        deltas[j] |= exception_high[e] << block.width;
+    }
+    std::uint32_t value = static_cast<std::uint32_t>(block.first);
+    for (std::size_t j = 0; j < kPackBlock; ++j) {
+        value += deltas[j];
+        out[j] = static_cast<int>(value);
+    }
+}
+
+void unpack_sorted(const PackedKeys& packed, Data& out) {
+    out.resize(packed.size);
+    std::array<int, kPackBlock> block;
+    for (std::size_t b = 0; b < packed.index.size(); ++b) {
+        std::size_t start = b * kPackBlock;
+        std::size_t count = std::min<std::size_t>(kPackBlock, packed.size - start);
+        if (count == kPackBlock) {
+            unpack_block(packed, b, out.data() + start);
+        } else {
+            unpack_block(packed, b, block.data());
+            std::copy(block.begin(), block.begin() + count, out.begin() + start);
+        }
+    }
+}
+
+int packed_at(const PackedKeys& packed, std::size_t i) {
+    std::array<int, kPackBlock> block;
+    unpack_block(packed, i / kPackBlock, block.data());
+    return block[i % kPackBlock];
+}
+
+void write_packed(const PackedKeys& packed, const std::string& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    std::uint64_t blocks = packed.index.size();
+    std::uint64_t words = packed.words.size();
+    file.write(kPackedMagic, sizeof(kPackedMagic));
+    file.write(reinterpret_cast<const char*>(&packed.size), sizeof(packed.size));
+    file.write(reinterpret_cast<const char*>(&blocks), sizeof(blocks));
+    file.write(reinterpret_cast<const char*>(&words), sizeof(words));
+    file.write(reinterpret_cast<const char*>(packed.index.data()),
+               static_cast<std::streamsize>(blocks * sizeof(PackedBlock)));
+    file.write(reinterpret_cast<const char*>(packed.words.data()),
+               static_cast<std::streamsize>(words * sizeof(std::uint32_t)));
+    if (!file) {
+        throw std::runtime_error("cannot write packed keys to " + path);
+    }
+}
+
+PackedKeys read_packed(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(kPackedMagic)] = {};
+    PackedKeys packed;
+    std::uint64_t blocks = 0;
+    std::uint64_t words = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&packed.size), sizeof(packed.size));
+    file.read(reinterpret_cast<char*>(&blocks), sizeof(blocks));
+    file.read(reinterpret_cast<char*>(&words), sizeof(words));
+    if (!file || !std::equal(magic, magic + sizeof(magic), kPackedMagic) ||
+        blocks != (packed.size + kPackBlock - 1) / kPackBlock) {
+        throw std::runtime_error(path + " is not a packed key file");
+    }
+    packed.index.resize(blocks);
+    packed.words.resize(words);
+    file.read(reinterpret_cast<char*>(packed.index.data()),
+              static_cast<std::streamsize>(blocks * sizeof(PackedBlock)));
+    file.read(reinterpret_cast<char*>(packed.words.data()),
+              static_cast<std::streamsize>(words * sizeof(std::uint32_t)));
+    if (!file) {
+        throw std::runtime_error(path + " is truncated");
+    }
+    for (const PackedBlock& block : packed.index) {
+        if (block.width > 32 || block.exceptions > (block.width < 32 ? kPackBlock : 0) ||
+            block.offset + packed_block_words(block.width, block.exceptions) > words) {
+            throw std::runtime_error(path + " has a corrupt block index");
+        }
+    }
+    return packed;
+}
+
+// Double-buffered file I/O for out-of-core sorting. A background thread keeps
+// up to `buffers` kDirectIoAlignment-aligned buffers in flight, so reading chunk i + 1 (or
+// writing chunk i - 1) overlaps with the caller working on chunk i; a single
+// buffer makes either side synchronous. With direct set the file is opened
+// O_DIRECT to bypass the page cache, falling back to buffered I/O on file
+// systems that refuse it. A failure on the I/O thread is rethrown to the
+// caller on its next call.
+constexpr std::size_t kIoBuffers = 2;
+constexpr std::size_t kIoBufferBytes = std::size_t{4} << 20;
+constexpr std::size_t kDirectIoAlignment = 4096;
+
+struct IoOptions {
+    bool direct = false;
+    std::size_t buffers = kIoBuffers;
+};
+
+int open_for_io(const std::string& path, int flags, bool& direct) {
+    int fd = -1;
+    if (direct) {
+        fd = open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd < 0 && errno == EINVAL) {
+            direct = false;
         }
-        data.swap(output);
     }
+    if (!direct) {
+        fd = open(path.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    }
+    return fd;
 }
 
-struct ListNode {
-    int value;
-    ListNode* next;
+// Buffer slots are handed over through two monotonically increasing counters:
+// slot produced % count is filled next and slot consumed % count drained next.
+// Slots are aligned for O_DIRECT explicitly rather than through
+// allocate_buffer(), which only page-aligns huge mappings.
+struct IoRing {
+    IoRing(std::size_t count, std::size_t bytes)
+        : bytes(bytes), slots(std::max<std::size_t>(count, 1)), counts(slots.size(), 0) {
+        for (int*& slot : slots) {
+            slot = static_cast<int*>(::operator new(bytes, std::align_val_t{kDirectIoAlignment}));
+        }
+    }
+
+    ~IoRing() {
+        for (int* slot : slots) {
+            ::operator delete(slot, std::align_val_t{kDirectIoAlignment});
+        }
+    }
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    std::size_t bytes;
+    std::vector<int*> slots;
+    std::vector<std::size_t> counts;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t produced = 0;
+    std::size_t consumed = 0;
+    bool finished = false;
+    std::exception_ptr error;
 };
 
-ListNode* list_insertion_sort(ListNode* head) {
-    ListNode dummy{0, nullptr};
-    ListNode* current = head;
-    while (current) {
-        ListNode* next = current->next;
-        ListNode* prev = &dummy;
-        while (prev->next && prev->next->value < current->value) {
-            prev = prev->next;
+class AsyncFileReader {
+public:
+    AsyncFileReader(const std::string& path, const IoOptions& options,
+                    std::size_t buffer_bytes = kIoBufferBytes)
+        : direct_(options.direct),
+          fd_(open_for_io(path, O_RDONLY, direct_)),
+          path_(path),
+          ring_(options.buffers, buffer_bytes),
+          thread_([this] { run(); }) {}
+
+    ~AsyncFileReader() {
+        {
+            std::lock_guard<std::mutex> lock(ring_.mutex);
+            ring_.finished = true;
         }
-        current->next = prev->next;
-        prev->next = current;
-        current = next;
+        ring_.changed.notify_all();
+        thread_.join();
+        close(fd_);
     }
-    return dummy.next;
-}
 
-ListNode* build_list(const Data& data) {
-    ListNode* head = nullptr;
-    ListNode* tail = nullptr;
-    for (int value : data) {
-        auto* node = new ListNode{value, nullptr};
-        if (!head) {
-            head = tail = node;
-        } else {
-            tail->next = node;
-            tail = node;
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    // The next chunk of the file, valid until the following call; empty at
+    // end of file.
+    MergeRun next() {
+        std::unique_lock<std::mutex> lock(ring_.mutex);
+        if (holding_) {
+            ++ring_.consumed;
+            holding_ = false;
+            ring_.changed.notify_all();
+        }
+        ring_.changed.wait(lock, [this] {
+            return ring_.produced > ring_.consumed || ring_.finished || ring_.error;
+        });
+        if (ring_.error) {
+            std::rethrow_exception(ring_.error);
         }
+        if (ring_.produced == ring_.consumed) {
+            return {nullptr, nullptr};
+        }
+        std::size_t slot = ring_.consumed % ring_.slots.size();
+        holding_ = true;
+        const int* values = ring_.slots[slot];
+        return {values, values + ring_.counts[slot]};
     }
-    return head;
+
+private:
+    void run() {
+        try {
+            while (true) {
+                std::size_t slot;
+                {
+                    std::unique_lock<std::mutex> lock(ring_.mutex);
+                    ring_.changed.wait(lock, [this] {
+                        return ring_.produced - ring_.consumed < ring_.slots.size() ||
+                               ring_.finished;
+                    });
+                    if (ring_.finished) {
+                        return;
+                    }
+                    slot = ring_.produced % ring_.slots.size();
+                }
+                char* buffer = reinterpret_cast<char*>(ring_.slots[slot]);
+                std::size_t filled = 0;
+                while (filled < ring_.bytes) {
+                    ssize_t got = read(fd_, buffer + filled, ring_.bytes - filled);
+                    if (got < 0) {
+                        throw std::runtime_error("read from " + path_ + " failed: " +
+                                                 std::strerror(errno));
+                    }
+                    if (got == 0) {
+                        break;
+                    }
+                    filled += static_cast<std::size_t>(got);
+                }
+                if (filled % sizeof(int) != 0) {
+                    throw std::runtime_error(path_ + " does not hold whole keys");
+                }
+                std::lock_guard<std::mutex> lock(ring_.mutex);
+                if (filled == 0) {
+                    ring_.finished = true;
+                } else {
+                    ring_.counts[slot] = filled / sizeof(int);
+                    ++ring_.produced;
+                }
+                ring_.changed.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(ring_.mutex);
+            ring_.error = std::current_exception();
+            ring_.changed.notify_all();
+        }
+    }
+
+    bool direct_;
+    int fd_;
+    std::string path_;
+    IoRing ring_;
+    bool holding_ = false;
+    std::thread thread_;
+};
+
+class AsyncFileWriter {
+public:
+    AsyncFileWriter(const std::string& path, const IoOptions& options,
+                    std::size_t buffer_bytes = kIoBufferBytes)
+        : direct_(options.direct),
+          fd_(open_for_io(path, O_WRONLY | O_CREAT | O_TRUNC, direct_)),
+          path_(path),
+          ring_(options.buffers, buffer_bytes),
+          thread_([this] { run(); }) {}
+
+    ~AsyncFileWriter() {
+        try {
+            finish();
+        } catch (const std::exception&) {
+        }
+    }
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    void write(const int* values, std::size_t n) {
+        const std::size_t capacity = ring_.bytes / sizeof(int);
+        while (n > 0) {
+            if (!filling_) {
+                std::unique_lock<std::mutex> lock(ring_.mutex);
+                ring_.changed.wait(lock, [this] {
+                    return ring_.produced - ring_.consumed < ring_.slots.size() || ring_.error;
+                });
+                if (ring_.error) {
+                    std::rethrow_exception(ring_.error);
+                }
+                filling_ = ring_.slots[ring_.produced % ring_.slots.size()];
+                filled_ = 0;
+            }
+            std::size_t take = std::min(n, capacity - filled_);
+            std::copy(values, values + take, filling_ + filled_);
+            filled_ += take;
+            values += take;
+            n -= take;
+            if (filled_ == capacity) {
+                submit();
+            }
+        }
+    }
+
+    // Flushes the last partial buffer, waits for the I/O thread and closes
+    // the file.
+    void finish() {
+        if (fd_ < 0) {
+            return;
+        }
+        if (filling_ && filled_ > 0) {
+            submit();
+        }
+        {
+            std::lock_guard<std::mutex> lock(ring_.mutex);
+            ring_.finished = true;
+        }
+        ring_.changed.notify_all();
+        thread_.join();
+        int error = 0;
+        if (direct_ && ftruncate(fd_, static_cast<off_t>(written_)) != 0) {
+            error = errno;
+        }
+        close(fd_);
+        fd_ = -1;
+        if (ring_.error) {
+            std::rethrow_exception(ring_.error);
+        }
+        if (error != 0) {
+            throw std::runtime_error("truncating " + path_ + " failed: " + std::strerror(error));
+        }
+    }
+
+private:
+    void submit() {
+        std::lock_guard<std::mutex> lock(ring_.mutex);
+        ring_.counts[ring_.produced % ring_.slots.size()] = filled_;
+        ++ring_.produced;
+        filling_ = nullptr;
+        ring_.changed.notify_all();
+    }
+
+    void run() {
+        try {
+            while (true) {
+                std::size_t slot;
+                {
+                    std::unique_lock<std::mutex> lock(ring_.mutex);
+                    ring_.changed.wait(lock, [this] {
+                        return ring_.consumed < ring_.produced || ring_.finished;
+                    });
+                    if (ring_.consumed == ring_.produced) {
+                        return;
+                    }
+                    slot = ring_.consumed % ring_.slots.size();
+                }
+                // O_DIRECT writes whole blocks; the padding is truncated away
+                // in finish().
+                std::size_t bytes = ring_.counts[slot] * sizeof(int);
+                written_ += bytes;
+                if (direct_) {
+                    std::size_t padded = (bytes + kDirectIoAlignment - 1) / kDirectIoAlignment *
+                                         kDirectIoAlignment;
+                    std::fill(reinterpret_cast<char*>(ring_.slots[slot]) + bytes,
+                              reinterpret_cast<char*>(ring_.slots[slot]) + padded, 0);
+                    bytes = padded;
+                }
+                const char* buffer = reinterpret_cast<const char*>(ring_.slots[slot]);
+                std::size_t done = 0;
+                while (done < bytes) {
+                    ssize_t put = ::write(fd_, buffer + done, bytes - done);
+                    if (put < 0) {
+                        throw std::runtime_error("write to " + path_ + " failed: " +
+                                                 std::strerror(errno));
+                    }
+                    done += static_cast<std::size_t>(put);
+                }
+                std::lock_guard<std::mutex> lock(ring_.mutex);
+                ++ring_.consumed;
+                ring_.changed.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(ring_.mutex);
+            ring_.error = std::current_exception();
+            ring_.changed.notify_all();
+        }
+    }
+
+    bool direct_;
+    int fd_;
+    std::string path_;
+    IoRing ring_;
+    int* filling_ = nullptr;
+    std::size_t filled_ = 0;
+    std::size_t written_ = 0;
+    std::thread thread_;
+};
+
+// Out-of-core merge sort of a file of keys: radix sort run_keys at a time
+// into run files, then merge the runs in rounds. Each round takes, from every
+// run's current chunk, only the keys no larger than the smallest chunk tail,
+// since no later chunk can hold a smaller key; at least one chunk is then
+// used up and refilled from its reader.
+struct ExternalSortStats {
+    std::size_t runs = 0;
+    double run_seconds = 0.0;
+    double merge_seconds = 0.0;
+};
+
+ExternalSortStats external_sort(const std::string& input, const std::string& output,
+                                std::size_t run_keys, const IoOptions& options) {
+    ExternalSortStats stats;
+    std::vector<std::string> run_paths;
+    Timer run_timer;
+    {
+        AsyncFileReader reader(input, options);
+        Data run;
+        run.reserve(run_keys);
+        auto flush_run = [&] {
+            radix_sort(run);
+            run_paths.push_back(output + ".run" + std::to_string(run_paths.size()));
+            AsyncFileWriter writer(run_paths.back(), options);
+            writer.write(run.data(), run.size());
+            writer.finish();
+            run.clear();
+        };
+        for (MergeRun chunk = reader.next(); chunk.head != chunk.tail; chunk = reader.next()) {
+            while (chunk.head != chunk.tail) {
+                std::size_t take = std::min<std::size_t>(run_keys - run.size(),
+                                                         chunk.tail - chunk.head);
+                run.insert(run.end(), chunk.head, chunk.head + take);
+                chunk.head += take;
+                if (run.size() == run_keys) {
+                    flush_run();
+                }
+            }
+        }
+        if (!run.empty()) {
+            flush_run();
+        }
+    }
+    stats.runs = run_paths.size();
+    stats.run_seconds = run_timer.elapsed_seconds();
+
+    Timer merge_timer;
+    {
+        std::vector<std::unique_ptr<AsyncFileReader>> readers;
+        std::vector<MergeRun> chunks;
+        for (const std::string& path : run_paths) {
+            readers.push_back(std::make_unique<AsyncFileReader>(path, options));
+            chunks.push_back(readers.back()->next());
+        }
+        AsyncFileWriter writer(output, options);
+        LoserTree tree;
+        std::vector<MergeRun> prefixes(chunks.size());
+        Data staged(std::max<std::size_t>(chunks.size(), 1) * (kIoBufferBytes / sizeof(int)));
+        while (true) {
+            bool pending = false;
+            int bound = std::numeric_limits<int>::max();
+            for (const MergeRun& chunk : chunks) {
+                if (chunk.head != chunk.tail) {
+                    pending = true;
+                    bound = std::min(bound, *(chunk.tail - 1));
+                }
+            }
+            if (!pending) {
+                break;
+            }
+            for (std::size_t r = 0; r < chunks.size(); ++r) {
+                const int* cut = std::upper_bound(chunks[r].head, chunks[r].tail, bound);
+                prefixes[r] = {chunks[r].head, cut};
+                chunks[r].head = cut;
+            }
+            int* end = kway_merge(tree, prefixes, staged.data());
+            writer.write(staged.data(), static_cast<std::size_t>(end - staged.data()));
+            for (std::size_t r = 0; r < chunks.size(); ++r) {
+                if (chunks[r].head == chunks[r].tail) {
+                    chunks[r] = readers[r]->next();
+                }
+            }
+        }
+        writer.finish();
+    }
+    for (const std::string& path : run_paths) {
+        unlink(path.c_str());
+    }
+    stats.merge_seconds = merge_timer.elapsed_seconds();
+    return stats;
 }
 
-void free_list(ListNode* head) {
-    while (head) {
-        ListNode* next = head->next;
-        delete head;
-        head = next;
+// Spill size per external-sort run, as a fraction of the input.
+constexpr std::size_t kExternalRunsPerSort = 8;
+constexpr std::size_t kExternalMinRunKeys = std::size_t{1} << 16;
+
+// Memory traffic models: the bytes each sort moves between the last-level
+// cache and memory for n keys drawn from [0, 2n], counting one read and one
+// write per element for every pass that streams the whole array from memory.
+// A depth-first recursion only streams at levels whose subproblems exceed
+// the cache; below that each subproblem is read in and written back once.
+// A breadth-first sort (bottom-up merging, LSD radix) sweeps the whole array
+// on every pass, so all its passes stream unless the array fits. Passes that
+// stay in cache are left out, so figures are comparable between sorts.
+struct CacheModel {
+    static std::size_t& last_level_bytes() {
+        static std::size_t value = [] {
+            long bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+            if (bytes <= 0) {
+                bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+            }
+            return bytes > 0 ? static_cast<std::size_t>(bytes) : std::size_t{8} << 20;
+        }();
+        return value;
+    }
+};
+
+double bytes_per_pass(std::size_t n) {
+    return 2.0 * static_cast<double>(n) * sizeof(int);
+}
+
+bool fits_in_cache(double keys, double working_bytes) {
+    return keys * working_bytes <= static_cast<double>(CacheModel::last_level_bytes());
+}
+
+// working_bytes is the memory a subproblem needs per key (4 in place, 8 with
+// a scratch array); each level divides the subproblem size by fanout.
+double recursive_memory_passes(std::size_t n, double working_bytes, double fanout) {
+    double passes = 1.0;
+    double keys = static_cast<double>(n);
+    while (!fits_in_cache(keys, working_bytes)) {
+        passes += 1.0;
+        keys /= fanout;
+    }
+    return passes;
+}
+
+double sweep_memory_passes(std::size_t n, double working_bytes, std::size_t passes) {
+    return fits_in_cache(static_cast<double>(n), working_bytes) ? 1.0 : static_cast<double>(passes);
+}
+
+std::size_t radix_pass_count(std::size_t n, int bits) {
+    std::size_t key_bits = 0;
+    while (key_bits < static_cast<std::size_t>(std::numeric_limits<int>::digits) &&
+           ((2 * n) >> key_bits) > 0) {
+        ++key_bits;
+    }
+    return (key_bits + bits - 1) / bits;
+}
+
+double comparison_sort_traffic(std::size_t n) {
+    return bytes_per_pass(n) * recursive_memory_passes(n, sizeof(int), 2.0);
+}
+
+// merge() writes every element to temp and then copies it back.
+double merge_sort_traffic(std::size_t n) {
+    return 2.0 * bytes_per_pass(n) * recursive_memory_passes(n, 2 * sizeof(int), 2.0);
+}
+
+// Each level splits a run into about run^(1/3) runs of run^(2/3) keys.
+double funnel_sort_traffic(std::size_t n) {
+    double passes = 1.0;
+    for (double run = static_cast<double>(n); !fits_in_cache(run, 2 * sizeof(int));
+         run = std::pow(run, 2.0 / 3.0)) {
+        passes += 1.0;
+    }
+    return 2.0 * bytes_per_pass(n) * passes;
+}
+
+double multiway_merge_sort_traffic(std::size_t n) {
+    std::size_t passes = 1;
+    for (std::size_t width = kMultiwayInitialRun; width < n; width *= kMultiwayFanIn) {
+        ++passes;
     }
+    return bytes_per_pass(n) * sweep_memory_passes(n, 2 * sizeof(int), passes);
+}
+
+double dual_pivot_quick_sort_traffic(std::size_t n) {
+    return bytes_per_pass(n) * recursive_memory_passes(n, sizeof(int), 3.0);
+}
+
+// Each LSD pass reads the keys for the histogram and again for the scatter.
+double radix_sort_traffic(std::size_t n) {
+    return 1.5 * bytes_per_pass(n) *
+           sweep_memory_passes(n, 2 * sizeof(int), radix_pass_count(n, 8));
+}
+
+double radix_sort_11_bit_traffic(std::size_t n) {
+    return 1.5 * bytes_per_pass(n) *
+           sweep_memory_passes(n, 2 * sizeof(int), radix_pass_count(n, 11));
+}
+
+double american_flag_sort_traffic(std::size_t n) {
+    return 1.5 * bytes_per_pass(n) * recursive_memory_passes(n, sizeof(int), 256.0);
 }
 
 struct SortDefinition {
     std::string name;
     void (*sort_fn)(Data&);
     bool is_quadratic;
+    void (*controlled_fn)(Data&, SortControl&) = nullptr;
+    bool is_baseline = false;
+    double (*traffic_bytes)(std::size_t) = nullptr;
+    // False for sorts whose work runs in other threads or processes, whose
+    // operations the per-thread counters cannot see.
+    bool counts_ops = true;
+    // Below this size sort_fn falls back to another sort, so the row is
+    // skipped rather than timed under this name.
+    std::size_t min_size = 0;
 };
 
+// Baselines come first so every custom sort can be reported relative to the
+// fastest of them at the same size.
 const std::vector<SortDefinition> kSorts{
+    {"std::sort", std_sort, false, nullptr, true, comparison_sort_traffic},
+    {"std::stable_sort", std_stable_sort, false, nullptr, true, merge_sort_traffic},
+#ifdef SORT_BENCH_HAS_PARALLEL_STL
+    {"std::sort (par_unseq)", std_sort_par_unseq, false, nullptr, true, comparison_sort_traffic,
+     false},
+#endif
+    {"qsort", c_qsort, false, nullptr, true, merge_sort_traffic},
     {"Insertion Sort", insertion_sort, true},
     {"Selection Sort", selection_sort, true},
     {"Shell Sort", shell_sort, false},
     {"Heap Sort", heap_sort, false},
-    {"Merge Sort", merge_sort, false},
-    {"Quick Sort", quick_sort, false},
-    {"Radix Sort", radix_sort, false},
+    {"Merge Sort", merge_sort, false, merge_sort, false, merge_sort_traffic},
+    {"Merge Sort (branchless merge)", dispatched_merge_sort, false, nullptr, false, merge_sort_traffic},
+    {"Funnel Sort", funnel_sort, false, nullptr, false, funnel_sort_traffic},
+    {"Multiway Merge Sort", multiway_merge_sort, false, nullptr, false, multiway_merge_sort_traffic},
+    {"Quick Sort", quick_sort, false, quick_sort, false, comparison_sort_traffic},
+    {"Quick Sort (branchless partition)", dispatched_quick_sort, false, nullptr, false,
+     comparison_sort_traffic},
+    {"Dual-Pivot Quick Sort", dual_pivot_quick_sort, false, nullptr, false,
+     dual_pivot_quick_sort_traffic},
+    {"Radix Sort", radix_sort, false, radix_sort, false, radix_sort_traffic},
+    {"Radix Sort (8-bit, buffered)", radix_sort_buffered<8>, false, nullptr, false, radix_sort_traffic},
+    {"Radix Sort (11-bit, buffered)", radix_sort_buffered<11>, false, nullptr, false,
+     radix_sort_11_bit_traffic},
+    {"MSD Radix Sort (in-place)", american_flag_sort, false, nullptr, false, american_flag_sort_traffic},
+    {"Sample Sort (2 processes)", sample_sort<2>, false, nullptr, false, nullptr, false,
+     2 * kSampleOversampling},
+    {"Sample Sort (4 processes)", sample_sort<4>, false, nullptr, false, nullptr, false,
+     4 * kSampleOversampling},
+    {"Sample Sort (8 processes)", sample_sort<8>, false, nullptr, false, nullptr, false,
+     8 * kSampleOversampling},
+};
+
+struct AggregateSortDefinition {
+    std::string name;
+    void (*sort_fn)(Data&, Data&, Aggregate*);
+};
+
+const std::vector<AggregateSortDefinition> kAggregateSorts{
+    {"Radix Sort", radix_sort_pairs},
+    {"Merge Sort", merge_sort_pairs},
+};
+
+const std::vector<std::pair<AggregateKind, std::string>> kAggregateKinds{
+    {AggregateKind::unique, "unique keys"},
+    {AggregateKind::run_lengths, "run lengths"},
+    {AggregateKind::group_sums, "group-by sums"},
+};
+
+// Keys, values, their scratch, the staged totals and both results.
+constexpr std::size_t kAggregateBytesPerKey = 48;
+
+struct RecordSortDefinition {
+    std::string name;
+    void (*sort_fn)(std::vector<Record>&);
+};
+
+const std::vector<RecordSortDefinition> kRecordSorts{
+    {"Record Sort (direct)", sort_records_directly},
+    {"Record Sort (argsort + permute)", sort_records_indirectly},
+};
+
+struct ListSortDefinition {
+    std::string name;
+    ListNode* (*sort_fn)(ListNode*);
+    bool is_quadratic;
+};
+
+const std::vector<ListSortDefinition> kListSorts{
+    {"Linked-list Insertion Sort", list_insertion_sort<false>, true},
+    {"Linked-list Insertion Sort (prefetch)", list_insertion_sort<true>, true},
+    {"Linked-list Merge Sort", list_merge_sort<false>, false},
+    {"Linked-list Merge Sort (prefetch)", list_merge_sort<true>, false},
 };
 
+constexpr std::size_t kListSearchQueries = 16;
+
 bool should_skip(const SortDefinition& sort, std::size_t n, std::size_t quadratic_limit) {
     if (sort.is_quadratic && n > quadratic_limit) {
         return true;
@@ -318,12 +3437,173 @@ bool should_skip(const SortDefinition& sort, std::size_t n, std::size_t quadrati
     return false;
 }
 
+// The timed stage runs on one CPU while data generation, the per-sort input
+// copy and output verification run on helper threads pinned to the rest of
+// the process's CPUs, so they overlap with timing without sharing its core.
+// From kRooflineMinSize up the sort waits for them instead, since they would
+// still compete for the shared cache and memory bandwidth.
+struct PipelineCpus {
+    int timed_cpu = -1;
+    std::vector<int> helper_cpus;
+};
+
+// requested_cpu < 0 picks the first CPU the process may run on.
+PipelineCpus detect_pipeline_cpus(int requested_cpu) {
+    PipelineCpus cpus;
+    const cpu_set_t& allowed = process_cpus();
+    if (requested_cpu >= 0) {
+        if (requested_cpu >= CPU_SETSIZE || !CPU_ISSET(requested_cpu, &allowed)) {
+            throw std::runtime_error("Requested CPU is not available to this process.");
+        }
+        cpus.timed_cpu = requested_cpu;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed) || cpu == cpus.timed_cpu) {
+            continue;
+        }
+        if (cpus.timed_cpu < 0) {
+            cpus.timed_cpu = cpu;
+        } else {
+            cpus.helper_cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// sched_setaffinity with pid 0 applies to the calling thread only.
+bool pin_current_thread(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+std::string read_first_line(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line)) {
+        return "";
+    }
+    return line;
+}
+
+std::string cpu_governor(int cpu) {
+    return read_first_line("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                           "/cpufreq/scaling_governor");
+}
+
+// Faults in every page of the buffer from the timing thread, so the sort
+// does not pay for first-touch page faults or remote TLB state.
+void prefault(Data& data) {
+    constexpr std::size_t stride = 4096 / sizeof(int);
+    volatile int* values = data.data();
+    for (std::size_t i = 0; i < data.size(); i += stride) {
+        values[i] = values[i];
+    }
+}
+
+template <typename Fn>
+auto run_on_helpers(const PipelineCpus& cpus, Fn fn) -> std::future<decltype(fn())> {
+    return std::async(std::launch::async, [helpers = cpus.helper_cpus, fn = std::move(fn)]() mutable {
+        pin_current_thread(helpers);
+        return fn();
+    });
+}
+
+// STREAM-style copy kernel over buffers well beyond the last-level cache;
+// the best of several repetitions approximates sustainable bandwidth.
+constexpr std::size_t kStreamBytes = std::size_t{256} << 20;
+constexpr int kStreamRepetitions = 5;
+constexpr std::size_t kRooflineMinSize = 500'000;
+
+double calibrate_bandwidth(std::size_t max_bytes) {
+    std::size_t n = std::min(kStreamBytes, max_bytes / 2) / sizeof(int);
+    if (n == 0) {
+        return 0.0;
+    }
+    Data source(n, 1);
+    Data target(n, 0);
+    double best = 0.0;
+    for (int rep = 0; rep < kStreamRepetitions; ++rep) {
+        Timer timer;
+        std::copy(source.begin(), source.end(), target.begin());
+        double seconds = timer.elapsed_seconds();
+        if (seconds > 0.0) {
+            best = std::max(best, bytes_per_pass(n) / seconds);
+        }
+        source.swap(target);
+    }
+    return best;
+}
+
+struct GeneratedCase {
+    Data data;
+    std::string error;
+};
+
+GeneratedCase generate_case(std::size_t n, std::mt19937_64& rng, std::size_t max_bytes) {
+    GeneratedCase result;
+    try {
+        result.data = generate_random_data(n, rng, max_bytes);
+    } catch (const std::exception& ex) {
+        result.error = ex.what();
+    }
+    return result;
+}
+
+// Sorts many independent N-key arrays with the compile-time network and with
+// insertion sort, the usual choice for tiny inputs, and checks they agree.
+constexpr std::size_t kBatchKeys = std::size_t{1} << 22;
+
+template <std::size_t N>
+void benchmark_small_batches(std::mt19937_64& rng) {
+    std::vector<std::array<int, N>> batches(kBatchKeys / N);
+    std::uniform_int_distribution<int> dist(0, 1'000'000);
+    for (auto& batch : batches) {
+        for (int& value : batch) {
+            value = dist(rng);
+        }
+    }
+
+    std::vector<std::array<int, N>> by_insertion = batches;
+    Timer insertion_timer;
+    for (auto& batch : by_insertion) {
+        insertion_sort_range(batch.data(), batch.data() + N);
+    }
+    double insertion_seconds = insertion_timer.elapsed_seconds();
+
+    std::vector<std::array<int, N>> by_network = batches;
+    Timer network_timer;
+    for (auto& batch : by_network) {
+        network_sort(batch);
+    }
+    double network_seconds = network_timer.elapsed_seconds();
+
+    std::cout << "  N = " << N << " (" << kSortingNetwork<N>.size()
+              << " comparators): insertion sort " << insertion_seconds << " s, sorting network "
+              << network_seconds << " s (" << std::setprecision(2)
+              << insertion_seconds / network_seconds << "x)" << std::setprecision(6);
+    if (by_network != by_insertion) {
+        std::cout << " (RESULTS DIFFER)";
+    }
+    std::cout << '\n';
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
     std::size_t quadratic_limit = 50'000;
     std::size_t max_bytes = 2ull * 1024 * 1024 * 1024;
     bool include_enormous_size = true;
+    double time_budget = 0.0;
+    bool pipelined = true;
+    int requested_cpu = -1;
+    bool lock_memory = false;
+    std::string packed_prefix;
+    std::string external_dir;
+    IoOptions io_options;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -331,6 +3611,34 @@ int main(int argc, char* argv[]) {
             quadratic_limit = std::stoull(argv[++i]);
         } else if (arg == "--max-bytes" && i + 1 < argc) {
             max_bytes = std::stoull(argv[++i]);
+        } else if (arg == "--time-budget" && i + 1 < argc) {
+            time_budget = std::stod(argv[++i]);
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            requested_cpu = std::stoi(argv[++i]);
+        } else if (arg == "--external-sort" && i + 1 < argc) {
+            external_dir = argv[++i];
+        } else if (arg == "--cache-bytes" && i + 1 < argc) {
+            CacheModel::last_level_bytes() = std::stoull(argv[++i]);
+        } else if (arg == "--direct-io") {
+            io_options.direct = true;
+        } else if (arg == "--packed-output" && i + 1 < argc) {
+            packed_prefix = argv[++i];
+        } else if (arg == "--isa" && i + 1 < argc) {
+            std::string isa = argv[++i];
+            if (!select_kernels(isa)) {
+                std::cerr << "Unsupported --isa " << isa << "; this CPU supports:";
+                for (const SortKernels& kernels : supported_kernels()) {
+                    std::cerr << ' ' << kernels.isa;
+                }
+                std::cerr << '\n';
+                return 1;
+            }
+        } else if (arg == "--no-huge-pages") {
+            HugePagePolicy::enabled() = false;
+        } else if (arg == "--mlock") {
+            lock_memory = true;
+        } else if (arg == "--serial") {
+            pipelined = false;
         } else if (arg == "--skip-largest") {
             include_enormous_size = false;
         } else if (arg == "--help") {
@@ -339,6 +3647,16 @@ int main(int argc, char* argv[]) {
                       << "  --quadratic-limit N   Max size for insertion/selection sorts (default 50000)\n"
                       << "  --max-bytes B         Max bytes allowed when generating arrays (default 2147483648)\n"
                       << "  --skip-largest        Skip the 5,000,000,000 element case\n"
+                      << "  --time-budget S       Cancel merge/quick/radix sorts running longer than S seconds\n"
+                      << "  --serial              Run generation, copying and verification inline\n"
+                      << "  --cpu N               Pin the timed stage to CPU N\n"
+                      << "  --mlock               Lock all current and future pages in memory\n"
+                      << "  --no-huge-pages       Use plain aligned allocations for sort buffers\n"
+                      << "  --isa NAME            Force kernels for baseline, sse4.2, avx2 or avx512\n"
+                      << "  --cache-bytes B       Last-level cache size for the traffic models (default detected)\n"
+                      << "  --packed-output P     Write each sorted size as packed keys to P.<n>.sbpk\n"
+                      << "  --external-sort DIR   Also sort each size out of core through files in DIR\n"
+                      << "  --direct-io           Open external-sort files with O_DIRECT\n"
                       << "  --help                Show this message\n";
             return 0;
         } else {
@@ -349,49 +3667,426 @@ int main(int argc, char* argv[]) {
 
     std::random_device rd;
     std::mt19937_64 rng(rd());
+    std::mt19937_64 generation_rng(rd());
 
     std::cout << std::fixed << std::setprecision(6);
 
+    PipelineCpus cpus;
+    try {
+        cpus = detect_pipeline_cpus(requested_cpu);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << '\n';
+        return 1;
+    }
+    if (pipelined && cpus.helper_cpus.empty()) {
+        std::cout << "Pipeline: only one CPU available, running stages serially\n";
+        pipelined = false;
+    }
+    bool pinned = (pipelined || requested_cpu >= 0) && pin_current_thread({cpus.timed_cpu});
+    if (pipelined) {
+        std::cout << "Pipeline: timed stage on CPU " << cpus.timed_cpu << ", helpers on "
+                  << cpus.helper_cpus.size() << " other CPU(s)\n";
+    }
+
+    std::string mlock_status = "off";
+    if (lock_memory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            mlock_status = "on";
+        } else {
+            mlock_status = std::string("failed (") + std::strerror(errno) + ")";
+        }
+    }
+    std::string governor = cpu_governor(cpus.timed_cpu);
+    std::cout << "Environment: compiler " << __VERSION__ << ", timed CPU "
+              << (pinned ? std::to_string(cpus.timed_cpu) : std::string("unpinned"))
+              << ", governor " << (governor.empty() ? "unknown" : governor) << ", mlockall "
+              << mlock_status << ", huge pages " << (HugePagePolicy::enabled() ? "on" : "off")
+              << ", op counting " << (kCountOps ? "on" : "off") << ", kernels "
+              << active_kernels().isa << '\n';
+    if (!governor.empty() && governor != "performance") {
+        std::cout << "Warning: CPU frequency scaling is active (governor '" << governor
+                  << "'); timings may drift between runs\n";
+    }
+    const double peak_bandwidth = calibrate_bandwidth(max_bytes);
+    std::cout << "Bandwidth: " << std::setprecision(2) << peak_bandwidth / 1e9
+              << " GB/s peak (STREAM copy), last-level cache "
+              << CacheModel::last_level_bytes() / (1024.0 * 1024.0) << " MiB" << std::setprecision(6)
+              << '\n';
+
+    std::cout << "Small fixed-size batches (" << kBatchKeys << " keys each):\n";
+    benchmark_small_batches<4>(rng);
+    benchmark_small_batches<8>(rng);
+    benchmark_small_batches<16>(rng);
+    benchmark_small_batches<32>(rng);
+
+    std::vector<std::size_t> sizes;
     for (std::size_t size : kRequestedSizes) {
-        if (!include_enormous_size && size == 5'000'000'000ull) {
-            continue;
+        if (include_enormous_size || size != 5'000'000'000ull) {
+            sizes.push_back(size);
+        }
+    }
+
+    auto start_generation = [&](std::size_t index) {
+        std::future<GeneratedCase> pending;
+        if (pipelined && index < sizes.size() && !exceeds_reasonable_memory(sizes[index], max_bytes)) {
+            std::size_t n = sizes[index];
+            pending = run_on_helpers(cpus, [n, &generation_rng, max_bytes] {
+                return generate_case(n, generation_rng, max_bytes);
+            });
         }
+        return pending;
+    };
 
+    std::future<GeneratedCase> next_case = start_generation(0);
+    for (std::size_t index = 0; index < sizes.size(); ++index) {
+        std::size_t size = sizes[index];
         std::cout << "\nSize n = " << size << '\n';
-        Data base;
-        try {
-            if (exceeds_reasonable_memory(size, max_bytes)) {
-                std::cout << "  Skipped data generation: exceeds configured memory limit ("
-                          << max_bytes << " bytes)\n";
-                continue;
-            }
-            base = generate_random_data(size, rng, max_bytes);
-        } catch (const std::exception& ex) {
-            std::cout << "  Failed to generate data: " << ex.what() << '\n';
+        if (exceeds_reasonable_memory(size, max_bytes)) {
+            std::cout << "  Skipped data generation: exceeds configured memory limit ("
+                      << max_bytes << " bytes)\n";
+            continue;
+        }
+        GeneratedCase current = next_case.valid() ? next_case.get()
+                                                  : generate_case(size, generation_rng, max_bytes);
+        next_case = start_generation(index + 1);
+        if (!current.error.empty()) {
+            std::cout << "  Failed to generate data: " << current.error << '\n';
             continue;
         }
+        const Data& base = current.data;
+
+        auto start_copy = [&]() {
+            std::future<Data> pending;
+            if (pipelined) {
+                pending = run_on_helpers(cpus, [&base] { return base; });
+            }
+            return pending;
+        };
+        std::string checked_name;
+        std::future<bool> check;
+        auto report_check = [&]() {
+            if (check.valid() && !check.get()) {
+                std::cout << "  " << checked_name << ": OUTPUT NOT SORTED\n";
+            }
+        };
 
+        double best_baseline = 0.0;
+        std::future<Data> next_copy = start_copy();
         for (const auto& sort : kSorts) {
             if (should_skip(sort, size, quadratic_limit)) {
                 std::cout << "  " << sort.name << ": skipped (n beyond quadratic limit "
                           << quadratic_limit << ")\n";
                 continue;
             }
-            Data data = base;
+            if (size < sort.min_size) {
+                std::cout << "  " << sort.name << ": skipped (n below workers*oversampling "
+                          << sort.min_size << ")\n";
+                continue;
+            }
+            Data data = next_copy.valid() ? next_copy.get() : base;
+            next_copy = start_copy();
+            // The helpers share the last-level cache and DRAM with the timed
+            // sort, so sizes that get a roofline figure let them finish first
+            // rather than measure bandwidth under contention.
+            if (size >= kRooflineMinSize) {
+                if (next_copy.valid()) {
+                    next_copy.wait();
+                }
+                if (check.valid()) {
+                    check.wait();
+                }
+                if (next_case.valid()) {
+                    next_case.wait();
+                }
+            }
+            prefault(data);
+            op_counts() = OpCounts{};
             Timer timer;
-            sort.sort_fn(data);
+            if (time_budget > 0.0 && sort.controlled_fn) {
+                double fraction = 0.0;
+                SortControl control;
+                control.on_progress = [&fraction](double done) { fraction = done; };
+                control.cancel_requested = [&timer, time_budget] {
+                    return timer.elapsed_seconds() > time_budget;
+                };
+                try {
+                    sort.controlled_fn(data, control);
+                } catch (const SortCancelled&) {
+                    std::cout << "  " << sort.name << ": cancelled after " << timer.elapsed_seconds()
+                              << " s (" << fraction * 100.0 << "% done, budget " << time_budget
+                              << " s)\n";
+                    continue;
+                }
+            } else {
+                try {
+                    sort.sort_fn(data);
+                } catch (const std::exception& ex) {
+                    std::cout << "  " << sort.name << ": failed (" << ex.what() << ")\n";
+                    continue;
+                }
+            }
             double seconds = timer.elapsed_seconds();
-            std::cout << "  " << sort.name << ": " << seconds << " s\n";
+            std::cout << "  " << sort.name << ": " << seconds << " s";
+            if (sort.is_baseline) {
+                if (best_baseline == 0.0 || seconds < best_baseline) {
+                    best_baseline = seconds;
+                }
+            } else if (best_baseline > 0.0) {
+                std::cout << " (" << std::setprecision(2) << seconds / best_baseline
+                          << "x best baseline)" << std::setprecision(6);
+            }
+            if (sort.traffic_bytes && size >= kRooflineMinSize && seconds > 0.0 &&
+                peak_bandwidth > 0.0) {
+                double achieved = sort.traffic_bytes(size) / seconds;
+                std::cout << std::setprecision(2) << " [" << achieved / 1e9 << " GB/s, "
+                          << 100.0 * achieved / peak_bandwidth << "% of peak]" << std::setprecision(6);
+            }
+            if (kCountOps && size > 0 && !sort.counts_ops) {
+                std::cout << " [op counts n/a]";
+            } else if (kCountOps && size > 0) {
+                const OpCounts& counts = op_counts();
+                double n = static_cast<double>(size);
+                std::cout << std::setprecision(2) << " [comparisons/n " << counts.comparisons / n
+                          << ", swaps/n " << counts.swaps / n << ", moves/n " << counts.moves / n
+                          << ']' << std::setprecision(6);
+            }
+            std::cout << '\n';
+
+            report_check();
+            checked_name = sort.name;
+            if (pipelined) {
+                check = run_on_helpers(cpus, [sorted = std::move(data)] {
+                    return std::is_sorted(sorted.begin(), sorted.end());
+                });
+            } else if (!std::is_sorted(data.begin(), data.end())) {
+                std::cout << "  " << sort.name << ": OUTPUT NOT SORTED\n";
+            }
+        }
+        if (next_copy.valid()) {
+            next_copy.wait();
+        }
+        report_check();
+
+        if (base.empty()) {
+            continue;
+        }
+
+        Data sorted = base;
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<int> search_queries(kSearchQueries);
+        std::uniform_int_distribution<int> query_dist(0, sorted.back());
+        for (int& query : search_queries) {
+            query = query_dist(rng);
+        }
+        if (size > max_bytes / kSearchLayoutBytesPerKey) {
+            std::cout << "  Sorted Search: skipped (layouts exceed configured memory limit)\n";
+        } else {
+            Timer layout_timer;
+            const SearchLayouts layouts = build_search_layouts(sorted);
+            std::cout << "  Search layouts: built in " << layout_timer.elapsed_seconds()
+                      << " s (S+ tree height " << layouts.btree_offsets.size()
+                      << ", learned index " << layouts.learned.segments.size() << " segments in "
+                      << std::setprecision(1) << layouts.learned.bytes() / 1024.0 << " KiB vs "
+                      << layouts.btree.size() * sizeof(int) / 1024.0 << " KiB of S+ tree)"
+                      << std::setprecision(6) << '\n';
+            std::vector<std::size_t> expected(kSearchQueries);
+            for (std::size_t q = 0; q < kSearchQueries; ++q) {
+                expected[q] = std_lower_bound(layouts, search_queries[q]);
+            }
+            for (const auto& search : kSearches) {
+                std::size_t mismatches = 0;
+                Timer search_timer;
+                for (std::size_t q = 0; q < kSearchQueries; ++q) {
+                    mismatches += search.search_fn(layouts, search_queries[q]) != expected[q];
+                }
+                double seconds = search_timer.elapsed_seconds();
+                std::cout << "  " << search.name << ": " << seconds << " s for " << kSearchQueries
+                          << " queries (" << std::setprecision(1)
+                          << seconds * 1e9 / static_cast<double>(kSearchQueries) << " ns each)"
+                          << std::setprecision(6);
+                if (mismatches > 0) {
+                    std::cout << " (" << mismatches << " WRONG RESULTS)";
+                }
+                std::cout << '\n';
+            }
+        }
+
+        Timer pack_timer;
+        PackedKeys packed = pack_sorted(sorted);
+        double pack_seconds = pack_timer.elapsed_seconds();
+        if (!packed_prefix.empty()) {
+            std::string path = packed_prefix + "." + std::to_string(size) + ".sbpk";
+            write_packed(packed, path);
+            packed = read_packed(path);
+        }
+        Data unpacked;
+        Timer unpack_timer;
+        unpack_sorted(packed, unpacked);
+        double unpack_seconds = unpack_timer.elapsed_seconds();
+        std::size_t packed_mismatches = unpacked == sorted ? 0 : 1;
+        Timer access_timer;
+        for (std::size_t q = 0; q < kPackedReads; ++q) {
+            std::size_t i = static_cast<std::size_t>(search_queries[q]) % sorted.size();
+            packed_mismatches += packed_at(packed, i) != sorted[i];
+        }
+        double access_seconds = access_timer.elapsed_seconds();
+        double packed_bits = 8.0 * static_cast<double>(packed.bytes()) / static_cast<double>(size);
+        std::cout << "  Packed Output: " << std::setprecision(2) << packed_bits << " bits/key ("
+                  << 8.0 * sizeof(int) / packed_bits << "x smaller)" << std::setprecision(6)
+                  << ", pack " << pack_seconds << " s, unpack " << unpack_seconds << " s, "
+                  << kPackedReads << " random reads " << access_seconds << " s";
+        if (packed_mismatches > 0) {
+            std::cout << " (ROUND TRIP MISMATCH)";
+        }
+        std::cout << '\n';
+
+        if (!external_dir.empty()) {
+            const std::string input_path = external_dir + "/sort_bench_input.bin";
+            const std::string output_path = external_dir + "/sort_bench_output.bin";
+            const std::size_t run_keys =
+                std::max(kExternalMinRunKeys, size / kExternalRunsPerSort);
+            try {
+                Timer write_timer;
+                AsyncFileWriter input_writer(input_path, io_options);
+                input_writer.write(base.data(), base.size());
+                input_writer.finish();
+                double write_seconds = write_timer.elapsed_seconds();
+
+                IoOptions synchronous = io_options;
+                synchronous.buffers = 1;
+                ExternalSortStats blocking =
+                    external_sort(input_path, output_path, run_keys, synchronous);
+                ExternalSortStats overlapped =
+                    external_sort(input_path, output_path, run_keys, io_options);
+
+                std::size_t read_back = 0;
+                bool output_sorted = true;
+                AsyncFileReader output_reader(output_path, io_options);
+                for (MergeRun chunk = output_reader.next(); chunk.head != chunk.tail;
+                     chunk = output_reader.next()) {
+                    std::size_t count = static_cast<std::size_t>(chunk.tail - chunk.head);
+                    output_sorted = output_sorted && read_back + count <= size &&
+                                    std::equal(chunk.head, chunk.tail, sorted.begin() + read_back);
+                    read_back += count;
+                }
+                unlink(input_path.c_str());
+                unlink(output_path.c_str());
+
+                std::cout << "  External Sort (" << overlapped.runs << " runs, "
+                          << io_options.buffers << " buffers"
+                          << (io_options.direct ? ", O_DIRECT" : "") << "): "
+                          << overlapped.run_seconds + overlapped.merge_seconds << " s (runs "
+                          << overlapped.run_seconds << " s, merge " << overlapped.merge_seconds
+                          << " s) vs " << blocking.run_seconds + blocking.merge_seconds
+                          << " s with one buffer; input written in " << write_seconds << " s";
+                if (!output_sorted || read_back != size) {
+                    std::cout << " (OUTPUT NOT SORTED)";
+                }
+                std::cout << '\n';
+            } catch (const std::exception& ex) {
+                std::cout << "  External Sort: failed (" << ex.what() << ")\n";
+            }
+        }
+
+        if (size > max_bytes / kAggregateBytesPerKey) {
+            std::cout << "  Aggregates: skipped (exceeds configured memory limit)\n";
+        } else {
+            Data group_values(size);
+            std::uniform_int_distribution<int> value_dist(0, 1000);
+            for (int& value : group_values) {
+                value = value_dist(rng);
+            }
+            for (const auto& [kind, kind_name] : kAggregateKinds) {
+                const bool carry = kind == AggregateKind::group_sums;
+                for (const auto& sort : kAggregateSorts) {
+                    Data keys = base;
+                    Data values = carry ? group_values : Data{};
+                    Aggregate scanned{kind, {}, {}};
+                    Timer scan_timer;
+                    sort.sort_fn(keys, values, nullptr);
+                    scan_aggregate(keys, values, scanned);
+                    double scan_seconds = scan_timer.elapsed_seconds();
+
+                    keys = base;
+                    values = carry ? group_values : Data{};
+                    Aggregate fused{kind, {}, {}};
+                    Timer fused_timer;
+                    sort.sort_fn(keys, values, &fused);
+                    double fused_seconds = fused_timer.elapsed_seconds();
+
+                    std::cout << "  " << sort.name << " + " << kind_name << ": sort then scan "
+                              << scan_seconds << " s, fused " << fused_seconds << " s ("
+                              << std::setprecision(2) << scan_seconds / fused_seconds << "x)"
+                              << std::setprecision(6);
+                    if (fused.keys != scanned.keys || fused.totals != scanned.totals) {
+                        std::cout << " (FUSED RESULT DIFFERS)";
+                    }
+                    std::cout << '\n';
+                }
+            }
+        }
+
+        if (size > max_bytes / sizeof(Record)) {
+            std::cout << "  Record sorts: skipped (records exceed configured memory limit)\n";
+        } else {
+            const std::vector<Record> record_base = build_records(base);
+            for (const auto& sort : kRecordSorts) {
+                std::vector<Record> records = record_base;
+                Timer record_timer;
+                sort.sort_fn(records);
+                double seconds = record_timer.elapsed_seconds();
+                std::cout << "  " << sort.name << ": " << seconds << " s\n";
+            }
+        }
+        if (size > max_bytes / sizeof(ListNode)) {
+            std::cout << "  Linked-list sorts: skipped (nodes exceed configured memory limit)\n";
+            continue;
         }
+        std::vector<int> queries;
+        for (std::size_t q = 0; q < kListSearchQueries; ++q) {
+            queries.push_back(base[rng() % size]);
+        }
+        for (bool shuffled : {false, true}) {
+            const char* layout = shuffled ? " [shuffled nodes]" : " [sequential nodes]";
+            ListArena arena;
+            if (shuffled) {
+                shuffle_list_layout(arena, size, rng);
+            }
+            for (const auto& sort : kListSorts) {
+                if (sort.is_quadratic && size > quadratic_limit) {
+                    std::cout << "  " << sort.name << layout << ": skipped (n beyond quadratic limit "
+                              << quadratic_limit << ")\n";
+                    continue;
+                }
+                ListNode* list = build_list(base, arena);
+                Timer ll_timer;
+                ListNode* sorted = sort.sort_fn(list);
+                double seconds = ll_timer.elapsed_seconds();
+                std::cout << "  " << sort.name << layout << ": " << seconds << " s\n";
+                if (!list_is_sorted(sorted, size)) {
+                    std::cout << "  " << sort.name << layout << ": OUTPUT NOT SORTED\n";
+                }
+                free_list(arena);
+            }
 
-        if (size <= quadratic_limit && !base.empty()) {
-            Timer ll_timer;
-            ListNode* list = build_list(base);
-            ll_timer.reset();
-            ListNode* sorted = list_insertion_sort(list);
-            double seconds = ll_timer.elapsed_seconds();
-            std::cout << "  Linked-list Insertion Sort: " << seconds << " s\n";
-            free_list(sorted);
+            const ListNode* list = build_list(base, arena);
+            for (bool prefetch : {false, true}) {
+                std::size_t found = 0;
+                Timer search_timer;
+                for (int query : queries) {
+                    const ListNode* hit = prefetch ? list_find<true>(list, query)
+                                                   : list_find<false>(list, query);
+                    found += hit != nullptr;
+                }
+                double seconds = search_timer.elapsed_seconds();
+                std::cout << "  Linked-list Search" << (prefetch ? " (prefetch)" : "") << layout
+                          << ": " << seconds << " s";
+                if (found != queries.size()) {
+                    std::cout << " (missed " << queries.size() - found << " keys)";
+                }
+                std::cout << '\n';
+            }
+            free_list(arena);
         }
     }
 